@@ -0,0 +1,467 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//Benchmark of parsing, validation, lookup and formatting over a synthetic corpus.
+//	gs1-bench [scans] [seed] [profile]
+//profile: retail, pharma, fresh-meat, logistics, internal, mixed (default)
+
+#include "gs1-corpus.h"
+#include "../gs1-parse.h"
+#include "../gs1-assoc.h"
+#include "../gs1-batch.h"
+#include "../gs1-cache.h"
+#include "../gs1-context.h"
+#include "../gs1-format.h"
+#include "../gs1-hri.h"
+#include "../gs1-link.h"
+#include "../gs1-project.h"
+#include "../gs1-simd.h"
+#include "../gs1-validate.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+
+//allocation counter
+static unsigned long long allocations = 0;
+
+void* operator new(size_t size)
+{
+	allocations++;
+	void *p = malloc(size ? size : 1);
+	if (!p)
+		throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	free(p);
+}
+
+namespace
+{
+	struct Corpus
+	{
+		std::vector<std::string> scans;
+		std::vector<const char*> ptrs;
+		std::vector<int> lens;
+		long long fields;
+	};
+
+	struct Result
+	{
+		double ns_per_scan;
+		double fields_per_sec;
+		double allocs_per_scan;
+	};
+
+	template<class F>
+	Result measure(const Corpus &corpus, long long items, F run)
+	{
+		const int rounds = 5;
+		double best = 0;
+		unsigned long long allocs = 0;
+		for(int r=0; r<rounds; r++)
+		{
+			unsigned long long a0 = allocations;
+			std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+			run();
+			double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+			if ((r == 0) || (ns < best))
+				best = ns;
+			allocs = allocations - a0; //last round: warmed up
+		}
+
+		double scans = (double)corpus.scans.size();
+		Result result;
+		result.ns_per_scan = best / scans;
+		result.fields_per_sec = (double)items * 1e9 / best;
+		result.allocs_per_scan = (double)allocs / scans;
+		return result;
+	}
+
+	void report(const char *name, const Result &r)
+	{
+		printf("%-34s %10.1f ns/scan %12.0f fields/s %8.2f allocs/scan\n", name, r.ns_per_scan, r.fields_per_sec, r.allocs_per_scan);
+	}
+
+	volatile size_t sink = 0; //keeps results alive
+
+	//Digital Link form of a scan: first field in the path, the others as query parameters
+	void make_digital_link(std::string &uri, const std::vector<GS1::FieldView> &fields)
+	{
+		static const char hex[] = "0123456789ABCDEF";
+		uri = "https://id.gs1.org";
+		for(size_t f=0; f<fields.size(); f++)
+		{
+			uri += (f == 0) ? "/" : ((f == 1) ? "?" : "&");
+			uri.append(fields[f].text_ai.ptr, fields[f].text_ai.len);
+			uri += (f == 0) ? "/" : "=";
+			for(int k=0; k<fields[f].text_body.len; k++)
+			{
+				unsigned char c = (unsigned char)fields[f].text_body.ptr[k];
+				if (isalnum(c) || strchr("-._~", c))
+					uri.push_back((char)c);
+				else
+				{
+					uri.push_back('%');
+					uri.push_back(hex[c >> 4]);
+					uri.push_back(hex[c & 15]);
+				}
+			}
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int count = (argc > 1) ? atoi(argv[1]) : 100000;
+	unsigned int seed = (argc > 2) ? (unsigned int)strtoul(argv[2], 0, 10) : 1;
+	int profile = GS1::CorpusGS1::Mixed;
+	if (argc > 3)
+	{
+		for(int p=0; p<GS1::CorpusGS1::ProfileCount; p++)
+		{
+			if (!strcmp(argv[3], GS1::CorpusGS1::GetProfileName(p)))
+				profile = p;
+		}
+	}
+	if (count <= 0)
+		count = 1;
+
+	Corpus corpus;
+	GS1::CorpusGS1 generator(seed);
+	generator.Generate(corpus.scans, count, profile);
+
+	corpus.fields = 0;
+	long long bytes = 0;
+	for(size_t i=0; i<corpus.scans.size(); i++)
+	{
+		corpus.ptrs.push_back(corpus.scans[i].c_str());
+		corpus.lens.push_back((int)corpus.scans[i].length());
+		bytes += corpus.scans[i].length();
+
+		std::vector<GS1::FieldView> v;
+		if (!GS1::parse_gs1(v, corpus.scans[i].c_str()))
+		{
+			printf("corpus error at scan %d\n", (int)i);
+			return 1;
+		}
+		corpus.fields += v.size();
+	}
+
+	printf("corpus: %d scans (%s, seed %u), %.2f fields/scan, %.1f bytes/scan, SIMD level %d\n\n",
+		count, GS1::CorpusGS1::GetProfileName(profile), seed,
+		(double)corpus.fields / count, (double)bytes / count, GS1::get_simd_level());
+
+	//parsing
+	{
+		std::vector<GS1::FieldAI> fields;
+		report("parse_gs1 (FieldAI)", measure(corpus, corpus.fields, [&] {
+			for(size_t i=0; i<corpus.ptrs.size(); i++)
+			{
+				GS1::parse_gs1(fields, corpus.ptrs[i]);
+				sink += fields.size();
+			}
+		}));
+	}
+	{
+		std::vector<GS1::FieldView> fields;
+		GS1::ErrorView error;
+		report("parse_gs1 (FieldView)", measure(corpus, corpus.fields, [&] {
+			for(size_t i=0; i<corpus.ptrs.size(); i++)
+			{
+				GS1::parse_gs1(fields, corpus.ptrs[i], corpus.lens[i], error);
+				sink += fields.size();
+			}
+		}));
+	}
+	{
+		GS1::FieldsGS1 gs1;
+		report("FieldsGS1::ParseGS1", measure(corpus, corpus.fields, [&] {
+			for(size_t i=0; i<corpus.ptrs.size(); i++)
+			{
+				gs1.ParseGS1(corpus.ptrs[i]);
+				sink += gs1.GetCount();
+			}
+		}));
+	}
+	{
+		GS1::ContextGS1 context;
+		report("ContextGS1::ParseGS1", measure(corpus, corpus.fields, [&] {
+			for(size_t i=0; i<corpus.ptrs.size(); i++)
+			{
+				context.ParseGS1(corpus.ptrs[i], corpus.lens[i]);
+				sink += context.GetCount();
+			}
+		}));
+	}
+	{
+		GS1::BatchGS1 batch;
+		report("BatchGS1::ParseGS1", measure(corpus, corpus.fields, [&] {
+			batch.ParseGS1(&corpus.ptrs[0], &corpus.lens[0], (int)corpus.ptrs.size());
+			sink += batch.GetCount();
+		}));
+	}
+	{
+		//fields/s counts the whole scans, as in the lines above
+		GS1::ProjectionGS1 projection;
+		projection.Add("01");
+		projection.Add("17");
+		GS1::FieldView fields[2];
+		GS1::ErrorView error;
+		report("ProjectionGS1 (01, 17)", measure(corpus, corpus.fields, [&] {
+			for(size_t i=0; i<corpus.ptrs.size(); i++)
+				sink += projection.Parse(fields, corpus.ptrs[i], corpus.lens[i], error);
+		}));
+	}
+	{
+		//repeated labels: every scan is one of the first 256 corpus scans
+		const size_t labels = corpus.ptrs.size() < 256 ? corpus.ptrs.size() : 256;
+		std::vector<int> label_fields(labels);
+		for(size_t i=0; i<labels; i++)
+		{
+			std::vector<GS1::FieldView> v;
+			GS1::parse_gs1(v, corpus.ptrs[i]);
+			label_fields[i] = (int)v.size();
+		}
+		std::vector<size_t> picks(corpus.ptrs.size());
+		long long fields_count = 0;
+		for(size_t i=0; i<picks.size(); i++)
+		{
+			picks[i] = (i * 37) % labels;
+			fields_count += label_fields[picks[i]];
+		}
+
+		GS1::FieldsGS1 gs1;
+		report("FieldsGS1::ParseGS1 (256 labels)", measure(corpus, fields_count, [&] {
+			for(size_t i=0; i<picks.size(); i++)
+			{
+				gs1.ParseGS1(corpus.ptrs[picks[i]]);
+				sink += gs1.GetCount();
+			}
+		}));
+
+		GS1::CacheGS1 cache;
+		cache.Create(1024);
+		report("FieldsGS1 + CacheGS1 (256 labels)", measure(corpus, fields_count, [&] {
+			for(size_t i=0; i<picks.size(); i++)
+			{
+				cache.ParseGS1(gs1, corpus.ptrs[picks[i]]);
+				sink += gs1.GetCount();
+			}
+		}));
+		report("CacheGS1 view (256 labels)", measure(corpus, fields_count, [&] {
+			for(size_t i=0; i<picks.size(); i++)
+				sink += cache.ParseGS1(corpus.ptrs[picks[i]], corpus.lens[picks[i]])->fields.size();
+		}));
+
+		GS1::CacheGS1 small; //every scan misses
+		small.Create(16);
+		report("FieldsGS1 + CacheGS1 (misses)", measure(corpus, corpus.fields, [&] {
+			for(size_t i=0; i<corpus.ptrs.size(); i++)
+			{
+				small.ParseGS1(gs1, corpus.ptrs[i]);
+				sink += gs1.GetCount();
+			}
+		}));
+	}
+
+	//validation, right after parsing (compare with the parse lines above)
+	printf("\n");
+	{
+		std::vector<GS1::FieldView> fields;
+		GS1::ErrorView error;
+		report("parse_gs1 + validate_gs1", measure(corpus, corpus.fields, [&] {
+			for(size_t i=0; i<corpus.ptrs.size(); i++)
+			{
+				GS1::parse_gs1(fields, corpus.ptrs[i], corpus.lens[i], error);
+				sink += GS1::validate_gs1(fields, error);
+			}
+		}));
+
+		GS1::BatchGS1 batch;
+		std::vector<unsigned char> codes;
+		report("BatchGS1 + validate_gs1", measure(corpus, corpus.fields, [&] {
+			batch.ParseGS1(&corpus.ptrs[0], &corpus.lens[0], (int)corpus.ptrs.size());
+			codes.resize(batch.GetCount());
+			sink += GS1::validate_gs1(batch, &corpus.ptrs[0], &codes[0]);
+		}));
+
+		GS1::AssociationGS1 rules;
+		rules.AddDefaults();
+		report("parse_gs1 + AssociationGS1", measure(corpus, corpus.fields, [&] {
+			for(size_t i=0; i<corpus.ptrs.size(); i++)
+			{
+				GS1::parse_gs1(fields, corpus.ptrs[i], corpus.lens[i], error);
+				sink += rules.Check(fields, error);
+			}
+		}));
+		report("BatchGS1 + AssociationGS1", measure(corpus, corpus.fields, [&] {
+			batch.ParseGS1(&corpus.ptrs[0], &corpus.lens[0], (int)corpus.ptrs.size());
+			codes.resize(batch.GetCount());
+			sink += rules.Check(batch, &codes[0]);
+		}));
+	}
+
+	//the same scans in other input syntaxes
+	printf("\n");
+	{
+		std::vector<std::string> hri(corpus.scans.size());
+		std::vector<GS1::FieldView> fields;
+		for(size_t i=0; i<hri.size(); i++)
+		{
+			GS1::parse_gs1(fields, corpus.ptrs[i]);
+			GS1::format_hri(hri[i], fields);
+		}
+
+		GS1::ErrorView error;
+		report("parse_hri", measure(corpus, corpus.fields, [&] {
+			for(size_t i=0; i<hri.size(); i++)
+			{
+				GS1::parse_hri(fields, hri[i].c_str(), (int)hri[i].length(), error);
+				sink += fields.size();
+			}
+		}));
+	}
+	{
+		//Digital Link URIs are decoded in place, the copy is part of the time
+		std::vector<std::string> uris(corpus.scans.size());
+		std::vector<GS1::FieldView> fields;
+		for(size_t i=0; i<uris.size(); i++)
+		{
+			GS1::parse_gs1(fields, corpus.ptrs[i]);
+			make_digital_link(uris[i], fields);
+		}
+
+		std::vector<char> buf;
+		GS1::ErrorView error;
+		report("parse_digital_link (copy + parse)", measure(corpus, corpus.fields, [&] {
+			for(size_t i=0; i<uris.size(); i++)
+			{
+				buf.assign(uris[i].begin(), uris[i].end());
+				GS1::parse_digital_link(fields, &buf[0], (int)buf.size(), error);
+				sink += fields.size();
+			}
+		}));
+		report("parse_gs1_any (copy + parse)", measure(corpus, corpus.fields, [&] {
+			for(size_t i=0; i<corpus.ptrs.size(); i++)
+			{
+				buf.assign(corpus.ptrs[i], corpus.ptrs[i] + corpus.lens[i]);
+				GS1::parse_gs1_any(fields, &buf[0], (int)buf.size(), error);
+				sink += fields.size();
+			}
+		}));
+	}
+
+	//lookup
+	printf("\n");
+	{
+		std::vector<GS1::FieldsGS1> parsed(corpus.scans.size());
+		for(size_t i=0; i<parsed.size(); i++)
+			parsed[i].ParseGS1(corpus.ptrs[i]);
+
+		const char *codes[] = {"01", "17", "10", "310n"};
+		const int codes_count = sizeof(codes)/sizeof(codes[0]);
+		report("GetByAI(std::string) x4", measure(corpus, (long long)parsed.size() * codes_count, [&] {
+			for(size_t i=0; i<parsed.size(); i++)
+			{
+				for(int c=0; c<codes_count; c++)
+					sink += (size_t)parsed[i].GetByAI(std::string(codes[c]));
+			}
+		}));
+		report("GetByAI(const char*) x4", measure(corpus, (long long)parsed.size() * codes_count, [&] {
+			for(size_t i=0; i<parsed.size(); i++)
+			{
+				for(int c=0; c<codes_count; c++)
+					sink += (size_t)parsed[i].GetByAI(codes[c]);
+			}
+		}));
+
+		int ids[codes_count];
+		for(int c=0; c<codes_count; c++)
+			ids[c] = GS1::find_ai_id(codes[c]);
+		report("GetByAI(id) x4", measure(corpus, (long long)parsed.size() * codes_count, [&] {
+			for(size_t i=0; i<parsed.size(); i++)
+			{
+				for(int c=0; c<codes_count; c++)
+					sink += (size_t)parsed[i].GetByAI(ids[c]);
+			}
+		}));
+	}
+
+	//formatting
+	printf("\n");
+	{
+		std::vector<std::vector<GS1::FieldAI> > parsed(corpus.scans.size());
+		std::vector<std::vector<GS1::FieldView> > views(corpus.scans.size());
+		for(size_t i=0; i<parsed.size(); i++)
+		{
+			GS1::parse_gs1(parsed[i], corpus.ptrs[i]);
+			GS1::parse_gs1(views[i], corpus.ptrs[i]);
+		}
+
+		std::string text;
+		report("FieldAI::format_body", measure(corpus, corpus.fields, [&] {
+			for(size_t i=0; i<parsed.size(); i++)
+			{
+				for(size_t f=0; f<parsed[i].size(); f++)
+				{
+					parsed[i][f].format_body(text, true);
+					sink += text.length();
+				}
+			}
+		}));
+		report("format_json (FieldView)", measure(corpus, corpus.fields, [&] {
+			for(size_t i=0; i<views.size(); i++)
+			{
+				text.clear();
+				GS1::format_json(text, views[i]);
+				sink += text.length();
+			}
+		}));
+		report("format_csv (FieldView)", measure(corpus, corpus.fields, [&] {
+			for(size_t i=0; i<views.size(); i++)
+			{
+				text.clear();
+				GS1::format_csv(text, views[i]);
+				sink += text.length();
+			}
+		}));
+	}
+
+	return 0;
+}
@@ -0,0 +1,171 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-corpus.h"
+#include "../gs1-validate.h"
+
+#include <string.h>
+
+namespace GS1
+{
+	CorpusGS1::CorpusGS1(unsigned int seed)
+		: state(seed ? seed : 1)
+	{
+	}
+
+	unsigned int CorpusGS1::next()
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	int CorpusGS1::range(int min, int max)
+	{
+		return min + (int)(next() % (unsigned int)(max - min + 1));
+	}
+
+	const char* CorpusGS1::GetProfileName(int profile)
+	{
+		static const char *names[ProfileCount] = {"retail", "pharma", "fresh-meat", "logistics", "internal", "mixed"};
+		return ((profile >= 0) && (profile < ProfileCount)) ? names[profile] : "?";
+	}
+
+	void CorpusGS1::add_field(std::string &scan, const char *ai_code, int body_len_hint)
+	{
+		add_field(scan, get_ai_by_id(find_ai_id(ai_code)), body_len_hint);
+	}
+
+	//body_len_hint: 0 - random length within the spec, <0 - max length
+	void CorpusGS1::add_field(std::string &scan, const AI *ai, int body_len_hint)
+	{
+		static const char alnum[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz-./";
+
+		if (!ai)
+			return;
+
+		//the previous variable length field needs FNC1
+		if (!scan.empty() && (scan[scan.length()-1] == '\x01'))
+			scan[scan.length()-1] = GS1::FNC1;
+
+		int ai_len = (int)strlen(ai->ai);
+		for(int i=0; i<ai_len; i++)
+			scan.push_back((ai->ai[i] == 'n') ? (char)('0' + range(0, 5)) : ai->ai[i]);
+
+		int body_min = ai->field_len - ai_len;
+		int body_max = (ai->max_field_len_optional > 0) ? ai->max_field_len_optional - ai_len : body_min;
+		int len = body_min;
+		if (body_max > body_min)
+		{
+			if (body_len_hint < 0)
+				len = body_max;
+			else if (body_len_hint > 0)
+				len = (body_len_hint < body_max) ? body_len_hint : body_max;
+			else
+				len = range(body_min, body_max);
+		}
+
+		if (ai->data_format == GS1_DATE)
+		{
+			char date[7];
+			int yy = range(10, 35), mm = range(1, 12), dd = range(1, 28);
+			date[0] = (char)('0' + yy/10); date[1] = (char)('0' + yy%10);
+			date[2] = (char)('0' + mm/10); date[3] = (char)('0' + mm%10);
+			date[4] = (char)('0' + dd/10); date[5] = (char)('0' + dd%10);
+			scan.append(date, 6);
+		}
+		else
+		{
+			//numeric only unless the format has X components
+			bool numeric = ai->desc_format && !strchr(ai->desc_format, 'X');
+			for(int i=0; i<len; i++)
+				scan.push_back(numeric ? (char)('0' + range(0, 9)) : alnum[range(0, sizeof(alnum) - 2)]);
+
+			//SSCC, GTIN: valid check digit
+			if ((ai_len == 2) && (ai->ai[0] == '0'))
+				scan[scan.length()-1] = (char)('0' + mod10_check_digit(scan.c_str() + scan.length() - len, len - 1));
+		}
+
+		if (body_max > body_min)
+			scan.push_back('\x01'); //FNC1 placeholder, dropped if this field is the last one
+	}
+
+	void CorpusGS1::NextScan(std::string &scan, int profile)
+	{
+		scan.clear();
+
+		if (profile == Mixed)
+		{
+			//roughly: retail 40%, pharma 25%, fresh meat 15%, logistics 10%, internal 10%
+			int r = range(0, 99);
+			profile = (r < 40) ? Retail : (r < 65) ? Pharma : (r < 80) ? FreshMeat : (r < 90) ? Logistics : Internal;
+		}
+
+		switch(profile)
+		{
+		default:
+		case Retail:
+			add_field(scan, "01", 0);
+			add_field(scan, "17", 0);
+			add_field(scan, "10", range(4, 10));
+			break;
+		case Pharma:
+			add_field(scan, "01", 0);
+			add_field(scan, "17", 0);
+			add_field(scan, "10", range(4, 12));
+			add_field(scan, "21", range(8, 20));
+			break;
+		case FreshMeat:
+			add_field(scan, "01", 0);
+			add_field(scan, "310n", 0);
+			add_field(scan, "11", 0);
+			break;
+		case Logistics:
+			add_field(scan, "00", 0);
+			add_field(scan, "02", 0);
+			add_field(scan, "37", range(1, 4));
+			add_field(scan, "400", range(6, 20));
+			break;
+		case Internal:
+			{
+				add_field(scan, "01", 0);
+				add_field(scan, "10", range(4, 10));
+				char code[3] = {'9', (char)('0' + range(1, 9)), 0};
+				add_field(scan, code, (range(0, 3) == 0) ? 0 : -1);
+			}
+			break;
+		}
+
+		if (!scan.empty() && (scan[scan.length()-1] == '\x01'))
+			scan.erase(scan.length()-1);
+	}
+
+	void CorpusGS1::Generate(std::vector<std::string> &scans, int count, int profile)
+	{
+		scans.resize(count);
+		for(int i=0; i<count; i++)
+			NextScan(scans[i], profile);
+	}
+}
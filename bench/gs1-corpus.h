@@ -0,0 +1,69 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_CORPUS_H__
+#define __GS1_CORPUS_H__
+
+#include "../gs1-spec.h"
+
+#include <string>
+#include <vector>
+
+namespace GS1
+{
+	//Reproducible synthetic scans built from ai_list entries.
+	//The same seed always gives the same corpus on any platform (own PRNG, no rand()).
+	class CorpusGS1
+	{
+	public:
+		enum Profile
+		{
+			Retail = 0,		//01 + 17 + 10
+			Pharma = 1,		//01 + 17 + 10 + 21
+			FreshMeat = 2,	//01 + 310n + 11
+			Logistics = 3,	//00 + 02 + 37 + 400
+			Internal = 4,	//01 + 10 + long 9x internal fields
+			Mixed = 5,		//weighted mix of the above
+			ProfileCount = 6
+		};
+
+		explicit CorpusGS1(unsigned int seed = 1);
+
+		void NextScan(std::string &scan, int profile = Mixed);
+		void Generate(std::vector<std::string> &scans, int count, int profile = Mixed);
+
+		static const char* GetProfileName(int profile);
+
+	protected:
+		unsigned int next(); //xorshift32
+		int range(int min, int max); //inclusive
+
+		void add_field(std::string &scan, const char *ai_code, int body_len_hint);
+		void add_field(std::string &scan, const AI *ai, int body_len_hint);
+
+		unsigned int state;
+	};
+}
+
+#endif
@@ -0,0 +1,354 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-assoc.h"
+
+#include <string.h>
+
+namespace GS1
+{
+	//GS1 General Specifications 4.14, the rules that need only AI presence:
+	//{ai, "a|b"} - ai requires a or b, several entries of one ai must all hold;
+	//AIs that are not in the spec (e.g. 8026 in the default one) are left out
+	static const char *const default_requires[][2] =
+	{
+		{"02", "37"},
+		{"37", "02|8026"},
+		{"10", "01|02|8006|8026"}, {"11", "01|02|8006|8026"}, {"13", "01|02|8006|8026"},
+		{"15", "01|02|8006|8026"}, {"16", "01|02|8006|8026"}, {"17", "01|02|8006|8026"},
+		{"21", "01|8006"},
+		{"22", "01"},
+		{"250", "01"}, {"250", "21"},
+		{"254", "414"},
+		{"30", "01|8006"}
+	};
+
+	static const char *const default_excludes[][2] =
+	{
+		{"01", "02"}, {"01", "37"}, {"01", "8006"}, {"02", "8006"},
+		{"420", "421"}
+	};
+
+	//trade measures 3100..369n need a GTIN
+	static const char *const measure_requires = "01|02";
+
+	static inline bool any_bit(const AssociationMask &a, const AssociationMask &b)
+	{
+		unsigned long long r = 0;
+		for(int i=0; i<ASSOCIATION_WORDS; i++)
+			r |= a.w[i] & b.w[i];
+		return r != 0;
+	}
+
+	static inline bool all_bits(const AssociationMask &present, const AssociationMask &mask)
+	{
+		unsigned long long r = 0;
+		for(int i=0; i<ASSOCIATION_WORDS; i++)
+			r |= mask.w[i] & ~present.w[i];
+		return r == 0;
+	}
+
+	AssociationGS1::AssociationGS1()
+	{
+		Clear();
+	}
+
+	void AssociationGS1::Clear()
+	{
+		bit_by_id.assign(get_ai_count(), -1);
+		bit_count = 0;
+		first_rule.assign(get_ai_count() + 1, 0);
+		masks.clear();
+		kinds.clear();
+	}
+
+	int AssociationGS1::get_bit(const char *ai, int &id)
+	{
+		id = find_ai_id(ai);
+		if ((id < 0) || (id >= (int)bit_by_id.size()))
+			return -1;
+		if ((bit_by_id[id] < 0) && (bit_count < ASSOCIATION_MAX_AI))
+			bit_by_id[id] = (short)bit_count++;
+		return bit_by_id[id];
+	}
+
+	//RequireAll and ExcludeAll rules of one AI are merged, RequireOne rules are kept apart
+	void AssociationGS1::add_rule(int id, Kind kind, const AssociationMask &mask)
+	{
+		int pos = first_rule[id + 1];
+		if (kind != RequireOne)
+		{
+			for(int r=first_rule[id]; r<pos; r++)
+			{
+				if (kinds[r] == kind)
+				{
+					for(int i=0; i<ASSOCIATION_WORDS; i++)
+						masks[r].w[i] |= mask.w[i];
+					return;
+				}
+			}
+		}
+
+		masks.insert(masks.begin() + pos, mask);
+		kinds.insert(kinds.begin() + pos, (unsigned char)kind);
+		for(size_t i=id + 1; i<first_rule.size(); i++)
+			first_rule[i]++;
+	}
+
+	bool AssociationGS1::Require(const char *ai, const char *required)
+	{
+		int id, required_id;
+		if ((get_bit(ai, id) < 0) || (get_bit(required, required_id) < 0))
+			return false;
+
+		AssociationMask mask;
+		memset(&mask, 0, sizeof(mask));
+		int bit = bit_by_id[required_id];
+		mask.w[bit >> 6] |= 1ULL << (bit & 63);
+		add_rule(id, RequireAll, mask);
+		return true;
+	}
+
+	bool AssociationGS1::RequireAny(const char *ai, const char * const *required, int count)
+	{
+		int id;
+		if ((get_bit(ai, id) < 0) || (count <= 0))
+			return false;
+
+		AssociationMask mask;
+		memset(&mask, 0, sizeof(mask));
+		for(int i=0; i<count; i++)
+		{
+			int required_id;
+			int bit = get_bit(required[i], required_id);
+			if (bit < 0)
+				return false;
+			mask.w[bit >> 6] |= 1ULL << (bit & 63);
+		}
+		add_rule(id, count == 1 ? RequireAll : RequireOne, mask);
+		return true;
+	}
+
+	bool AssociationGS1::Exclude(const char *ai, const char *other)
+	{
+		int id, other_id;
+		int bit = get_bit(ai, id);
+		int other_bit = get_bit(other, other_id);
+		if ((bit < 0) || (other_bit < 0))
+			return false;
+
+		AssociationMask mask;
+		memset(&mask, 0, sizeof(mask));
+		mask.w[other_bit >> 6] |= 1ULL << (other_bit & 63);
+		add_rule(id, ExcludeAll, mask);
+
+		memset(&mask, 0, sizeof(mask));
+		mask.w[bit >> 6] |= 1ULL << (bit & 63);
+		add_rule(other_id, ExcludeAll, mask);
+		return true;
+	}
+
+	//"a|b|c" -> RequireAny() of the AIs in the spec
+	static void add_default(AssociationGS1 &rules, const char *ai, const char *required)
+	{
+		const int MAX_ANY = 4;
+		char codes[MAX_ANY][8];
+		const char *list[MAX_ANY];
+		int count = 0;
+		for(const char *p=required; *p && (count < MAX_ANY); )
+		{
+			const char *end = strchr(p, '|');
+			int len = end ? (int)(end - p) : (int)strlen(p);
+			if (len < (int)sizeof(codes[0]))
+			{
+				memcpy(codes[count], p, len);
+				codes[count][len] = 0;
+				if (find_ai_id(codes[count]) >= 0)
+				{
+					list[count] = codes[count];
+					count++;
+				}
+			}
+			p += end ? len + 1 : len;
+		}
+		if (count > 0)
+			rules.RequireAny(ai, list, count);
+	}
+
+	void AssociationGS1::AddDefaults()
+	{
+		for(size_t i=0; i<sizeof(default_requires)/sizeof(default_requires[0]); i++)
+			add_default(*this, default_requires[i][0], default_requires[i][1]);
+
+		for(size_t i=0; i<sizeof(default_excludes)/sizeof(default_excludes[0]); i++)
+			Exclude(default_excludes[i][0], default_excludes[i][1]);
+
+		for(int id=0; id<get_ai_count(); id++)
+		{
+			const char *ai = get_ai_by_id(id)->ai;
+			if ((ai[0] == '3') && (ai[1] >= '1') && (ai[1] <= '6') && (strlen(ai) == 4))
+				add_default(*this, ai, measure_requires);
+		}
+	}
+
+	ErrorAI::ErrorCode AssociationGS1::check_ai(const AssociationMask &present, int id) const
+	{
+		if ((id < 0) || (id + 1 >= (int)first_rule.size()))
+			return ErrorAI::Ok;
+
+		for(int r=first_rule[id]; r<first_rule[id + 1]; r++)
+		{
+			const AssociationMask &mask = masks[r];
+			switch(kinds[r])
+			{
+			case RequireAll:
+				if (!all_bits(present, mask))
+					return ErrorAI::MissingAI;
+				break;
+			case RequireOne:
+				if (!any_bit(present, mask))
+					return ErrorAI::MissingAI;
+				break;
+			case ExcludeAll:
+				if (any_bit(present, mask))
+					return ErrorAI::ExcludedAI;
+				break;
+			}
+		}
+		return ErrorAI::Ok;
+	}
+
+	bool AssociationGS1::Check(const FieldView *fields, int count, ErrorView &error) const
+	{
+		error.reset(0);
+
+		AssociationMask present;
+		memset(&present, 0, sizeof(present));
+		for(int i=0; i<count; i++)
+			set_present(present, get_ai_id(fields[i].ai));
+
+		for(int i=0; i<count; i++)
+		{
+			const FieldView &f = fields[i];
+			ErrorAI::ErrorCode code = check_ai(present, get_ai_id(f.ai));
+			if (code != ErrorAI::Ok)
+			{
+				error.code = code;
+				error.ai = f.ai;
+				error.text_ai = f.text_ai;
+				error.reference_pos = f.reference_pos;
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool AssociationGS1::Check(const std::vector<FieldAI> &fields, ErrorAI &error) const
+	{
+		error.reset(0);
+
+		AssociationMask present;
+		memset(&present, 0, sizeof(present));
+		for(size_t i=0; i<fields.size(); i++)
+			set_present(present, get_ai_id(fields[i].ai));
+
+		for(size_t i=0; i<fields.size(); i++)
+		{
+			const FieldAI &f = fields[i];
+			ErrorAI::ErrorCode code = check_ai(present, get_ai_id(f.ai));
+			if (code != ErrorAI::Ok)
+			{
+				error.code = code;
+				error.ai = f.ai;
+				error.text_ai = f.text_ai;
+				error.reference_pos = f.reference_pos;
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool AssociationGS1::Check(const FieldsGS1 &fields, ErrorAI &error) const
+	{
+		error.reset(0);
+
+		AssociationMask present;
+		memset(&present, 0, sizeof(present));
+		int count = fields.GetCount();
+		for(int i=0; i<count; i++)
+			set_present(present, get_ai_id(fields.Get(i)->ai));
+
+		for(int i=0; i<count; i++)
+		{
+			const FieldAI &f = *fields.Get(i);
+			ErrorAI::ErrorCode code = check_ai(present, get_ai_id(f.ai));
+			if (code != ErrorAI::Ok)
+			{
+				error.code = code;
+				error.ai = f.ai;
+				error.text_ai = f.text_ai;
+				error.reference_pos = f.reference_pos;
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool AssociationGS1::Check(const BatchGS1 &batch, unsigned char *error_codes) const
+	{
+		const int *scan_index = batch.GetScanIndex();
+		const short *ai_id = batch.GetAIId();
+		const unsigned char *parse_code = batch.GetErrorCode();
+
+		bool ok = true;
+		int count = batch.GetCount();
+		for(int first=0; first<count; )
+		{
+			//rows of one scan
+			int end = first;
+			bool parsed = true;
+			AssociationMask present;
+			memset(&present, 0, sizeof(present));
+			for(; (end < count) && (scan_index[end] == scan_index[first]); end++)
+			{
+				if (parse_code[end] != ErrorAI::Ok)
+					parsed = false;
+				set_present(present, ai_id[end]);
+			}
+
+			for(int i=first; i<end; i++)
+			{
+				unsigned char code = parse_code[i];
+				if (parsed)
+					code = (unsigned char)check_ai(present, ai_id[i]);
+
+				error_codes[i] = code;
+				if (code != ErrorAI::Ok)
+					ok = false;
+			}
+			first = end;
+		}
+		return ok;
+	}
+}
@@ -0,0 +1,99 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_ASSOC_H__
+#define __GS1_ASSOC_H__
+
+#include "gs1-parse.h"
+#include "gs1-batch.h"
+
+namespace GS1
+{
+	const int ASSOCIATION_WORDS = 4;
+	const int ASSOCIATION_MAX_AI = 64 * ASSOCIATION_WORDS; //distinct AIs named by the rules
+
+	//set of AIs named by the rules, one bit each
+	typedef struct _tag_AssociationMask
+	{
+		unsigned long long w[ASSOCIATION_WORDS];
+	} AssociationMask;
+
+	//AI association rules that parse_gs1 does not enforce: an AI that needs other AIs in the same scan,
+	//and AIs that must not appear together.
+	//Rules are compiled into bitmasks: a scan is one presence mask, and every present AI with rules
+	//is checked by a few AND operations per rule kind. Rules keep AI ids, add them after load_spec().
+	class AssociationGS1
+	{
+	public:
+		AssociationGS1();
+
+		//false: unknown AI or more than ASSOCIATION_MAX_AI distinct AIs
+		bool Require(const char *ai, const char *required); //ai needs required
+		bool RequireAny(const char *ai, const char * const *required, int count); //ai needs at least one of required
+		bool Exclude(const char *ai, const char *other); //not in the same scan, both ways
+		void AddDefaults(); //a subset of GS1 General Specifications 4.14: mandatory associations and invalid pairs
+		void Clear();
+
+		int GetRuleCount() const { return (int)kinds.size(); }
+
+		//first field with a failed rule: MissingAI or ExcludedAI with that field's AI and position
+		bool Check(const FieldView *fields, int count, ErrorView &error) const;
+		bool Check(const std::vector<FieldView> &fields, ErrorView &error) const { return Check(fields.empty() ? 0 : &fields[0], (int)fields.size(), error); }
+		bool Check(const std::vector<FieldAI> &fields, ErrorAI &error) const;
+		bool Check(const FieldsGS1 &fields, ErrorAI &error) const;
+
+		//batch mode, as validate_gs1(batch): error_codes (batch.GetCount() items) gets the code of every row,
+		//error rows keep their parse error and the other rows of that scan are not checked; false if any row is not Ok
+		bool Check(const BatchGS1 &batch, unsigned char *error_codes) const;
+
+	protected:
+		enum Kind
+		{
+			RequireAll = 0, //(present & mask) == mask
+			RequireOne = 1, //(present & mask) != 0
+			ExcludeAll = 2 //(present & mask) == 0
+		};
+
+		int get_bit(const char *ai, int &id); //assigns bits, -1 if unknown or full
+		void add_rule(int id, Kind kind, const AssociationMask &mask);
+
+		inline void set_present(AssociationMask &present, int id) const
+		{
+			int bit = ((id >= 0) && (id < (int)bit_by_id.size())) ? bit_by_id[id] : -1;
+			if (bit >= 0)
+				present.w[bit >> 6] |= 1ULL << (bit & 63);
+		}
+		ErrorAI::ErrorCode check_ai(const AssociationMask &present, int id) const;
+
+		std::vector<short> bit_by_id; //-1 - not named by the rules
+		int bit_count;
+
+		//rules of AI id are [first_rule[id], first_rule[id + 1])
+		std::vector<int> first_rule;
+		std::vector<AssociationMask> masks;
+		std::vector<unsigned char> kinds;
+	};
+}
+
+#endif
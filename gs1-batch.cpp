@@ -0,0 +1,111 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-batch.h"
+#include "gs1-stats.h"
+
+#include <string.h>
+
+namespace GS1
+{
+	//every field takes at least 2 AI digits + 1 body char (parse_gs1_field rejects empty bodies)
+	const int MIN_FIELD_LEN = 3;
+
+	BatchGS1::BatchGS1()
+		: arena(0), capacity(0), count(0), scan_count(0),
+		scan_index(0), body_pos(0), body_len(0), ai_id(0), error_code(0)
+	{
+	}
+
+	BatchGS1::~BatchGS1()
+	{
+		delete[] arena;
+	}
+
+	bool BatchGS1::reserve(int rows)
+	{
+		if (rows <= capacity)
+			return true;
+
+		//int columns first, so every column stays aligned
+		const int row_size = 2*sizeof(int) + 2*sizeof(short) + sizeof(unsigned char);
+		char *ptr = new char[(size_t)rows * row_size];
+
+		delete[] arena;
+		arena = ptr;
+		capacity = rows;
+
+		scan_index = (int*)ptr;				ptr += rows * sizeof(int);
+		body_pos = (int*)ptr;				ptr += rows * sizeof(int);
+		body_len = (short*)ptr;				ptr += rows * sizeof(short);
+		ai_id = (short*)ptr;				ptr += rows * sizeof(short);
+		error_code = (unsigned char*)ptr;
+		return true;
+	}
+
+	bool BatchGS1::ParseGS1(const char * const *scans, int scans_count)
+	{
+		return ParseGS1(scans, 0, scans_count);
+	}
+
+	bool BatchGS1::ParseGS1(const char * const *scans, const int *scan_lens, int scans_count)
+	{
+		Clear();
+
+		//upper bound of rows: all fields of the shortest length plus an error row per scan
+		int rows = scans_count;
+		for(int s=0; s<scans_count; s++)
+			rows += (scan_lens ? scan_lens[s] : (int)strlen(scans[s])) / MIN_FIELD_LEN;
+
+		if (!reserve(rows))
+			return false;
+
+		scan_count = scans_count;
+
+		bool ok = true;
+		FieldView f;
+		ErrorView error;
+		for(int s=0; s<scans_count; s++)
+		{
+			GS1_STATS_SCAN(stats);
+			const char *gs1_stream = scans[s];
+			const char *ptr = gs1_stream;
+			const char *end = ptr + (scan_lens ? scan_lens[s] : (int)strlen(gs1_stream));
+
+			while(ptr < end)
+			{
+				if (!parse_gs1_field(f, gs1_stream, ptr, end, error))
+				{
+					add_row(s, get_ai_id(error.ai), error.reference_pos, 0, error.code);
+					ok = false;
+					break;
+				}
+
+				add_row(s, get_ai_id(f.ai), f.text_body.ptr - gs1_stream, f.text_body.len, ErrorAI::Ok);
+			}
+		}
+
+		return ok;
+	}
+}
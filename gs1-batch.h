@@ -0,0 +1,88 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_BATCH_H__
+#define __GS1_BATCH_H__
+
+#include "gs1-parse.h"
+
+namespace GS1
+{
+	//Columnar (SoA) result of many scans.
+	//Every row is a parsed field or, when a scan fails, one error row at the failure position.
+	//All columns live in one arena which is reallocated only when a batch needs more rows.
+	class BatchGS1
+	{
+	public:
+		BatchGS1();
+		~BatchGS1();
+
+		//same fields and ErrorAI codes as parse_gs1 per scan; false if any scan failed
+		bool ParseGS1(const char * const *scans, int scans_count);
+		bool ParseGS1(const char * const *scans, const int *scan_lens, int scans_count);
+
+		int GetCount() const { return count; }
+		int GetScanCount() const { return scan_count; }
+
+		//columns, GetCount() items each
+		const int* GetScanIndex() const { return scan_index; }
+		const int* GetBodyPos() const { return body_pos; } //offset in the scan (error row: error reference_pos)
+		const short* GetBodyLen() const { return body_len; } //error row: 0
+		const short* GetAIId() const { return ai_id; } //get_ai_by_id(), -1 if unknown
+		const unsigned char* GetErrorCode() const { return error_code; } //ErrorAI::ErrorCode
+
+		void Clear() { count = 0; scan_count = 0; }
+
+	protected:
+		bool reserve(int rows);
+		inline void add_row(int scan, int id, int pos, int len, int code)
+		{
+			scan_index[count] = scan;
+			body_pos[count] = pos;
+			body_len[count] = (short)len;
+			ai_id[count] = (short)id;
+			error_code[count] = (unsigned char)code;
+			count++;
+		}
+
+		char *arena;
+		int capacity; //rows
+		int count;
+		int scan_count;
+
+		int *scan_index;
+		int *body_pos;
+		short *body_len;
+		short *ai_id;
+		unsigned char *error_code;
+
+	private:
+		friend class BulkParseJob; //merges per chunk batches (gs1-bulk.cpp)
+
+		BatchGS1(const BatchGS1&);
+		BatchGS1& operator=(const BatchGS1&);
+	};
+}
+
+#endif
@@ -0,0 +1,315 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-bulk.h"
+
+#include <string.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace GS1
+{
+	class BulkJob
+	{
+	public:
+		virtual ~BulkJob() {}
+		virtual void work(int worker) = 0;
+	};
+
+	//worker 0 is the calling thread, the rest are kept waiting for the next job
+	class BulkPool
+	{
+	public:
+		explicit BulkPool(int threads_count);
+		~BulkPool();
+
+		int size() const { return (int)threads.size() + 1; }
+		void run(BulkJob &j); //returns when all workers have finished j
+
+	private:
+		void thread_main(int worker);
+
+		std::vector<std::thread> threads;
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable done;
+
+		BulkJob *job;
+		unsigned int generation;
+		int running;
+		bool stop;
+	};
+
+	BulkPool::BulkPool(int threads_count)
+		: job(0), generation(0), running(0), stop(false)
+	{
+		for(int i=1; i<threads_count; i++)
+			threads.push_back(std::thread(&BulkPool::thread_main, this, i));
+	}
+
+	BulkPool::~BulkPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+		wake.notify_all();
+
+		for(size_t i=0; i<threads.size(); i++)
+			threads[i].join();
+	}
+
+	void BulkPool::run(BulkJob &j)
+	{
+		if (threads.empty())
+		{
+			j.work(0);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			job = &j;
+			running = (int)threads.size();
+			generation++;
+		}
+		wake.notify_all();
+
+		j.work(0);
+
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [this] { return running == 0; });
+		job = 0;
+	}
+
+	void BulkPool::thread_main(int worker)
+	{
+		unsigned int seen = 0;
+		for(;;)
+		{
+			BulkJob *j;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [&] { return stop || (generation != seen); });
+				if (stop)
+					return;
+				seen = generation;
+				j = job;
+			}
+
+			j->work(worker);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if (--running == 0)
+				done.notify_one();
+		}
+	}
+
+	//range of chunk indexes [begin, end) packed to one word:
+	//the owner pops from the front, thieves pop from the back, both with CAS
+	struct alignas(64) ChunkRange
+	{
+		std::atomic<unsigned long long> range;
+
+		static unsigned long long pack(unsigned int begin, unsigned int end) { return ((unsigned long long)begin << 32) | end; }
+
+		bool pop_front(int &chunk)
+		{
+			unsigned long long v = range.load(std::memory_order_relaxed);
+			for(;;)
+			{
+				unsigned int begin = (unsigned int)(v >> 32), end = (unsigned int)v;
+				if (begin >= end)
+					return false;
+				if (range.compare_exchange_weak(v, pack(begin + 1, end)))
+				{
+					chunk = (int)begin;
+					return true;
+				}
+			}
+		}
+
+		bool pop_back(int &chunk)
+		{
+			unsigned long long v = range.load(std::memory_order_relaxed);
+			for(;;)
+			{
+				unsigned int begin = (unsigned int)(v >> 32), end = (unsigned int)v;
+				if (begin >= end)
+					return false;
+				if (range.compare_exchange_weak(v, pack(begin, end - 1)))
+				{
+					chunk = (int)(end - 1);
+					return true;
+				}
+			}
+		}
+	};
+
+	class BulkParseJob : public BulkJob
+	{
+	public:
+		BulkParseJob(BulkParserGS1 &parser, BatchGS1 &result, const char * const *scans, const int *scan_lens, int scan_count, int workers)
+			: parser(parser), result(result), scans(scans), scan_lens(scan_lens), scan_count(scan_count),
+			workers(workers), ranges(workers), copying(false), ok(true)
+		{
+			chunk_count = (scan_count + parser.chunk_scans - 1) / parser.chunk_scans;
+
+			//even initial split, stealing evens out the rest
+			for(int w=0; w<workers; w++)
+				ranges[w].range = ChunkRange::pack(
+					(unsigned int)((long long)chunk_count * w / workers),
+					(unsigned int)((long long)chunk_count * (w + 1) / workers));
+			next_copy = 0;
+		}
+
+		void work(int worker)
+		{
+			if (copying)
+			{
+				copy_chunks();
+				return;
+			}
+
+			int chunk;
+			while(next_chunk(worker, chunk))
+			{
+				int first = chunk * parser.chunk_scans;
+				int n = (first + parser.chunk_scans < scan_count) ? parser.chunk_scans : scan_count - first;
+				if (!parser.chunks[chunk]->ParseGS1(scans + first, scan_lens ? scan_lens + first : 0, n))
+					ok = false;
+			}
+		}
+
+		bool merge(BulkPool &pool)
+		{
+			int rows = 0;
+			offsets.resize(chunk_count);
+			for(int c=0; c<chunk_count; c++)
+			{
+				offsets[c] = rows;
+				rows += parser.chunks[c]->count;
+			}
+
+			result.Clear();
+			result.reserve(rows);
+			result.count = rows;
+			result.scan_count = scan_count;
+
+			copying = true;
+			pool.run(*this);
+			return ok;
+		}
+
+	protected:
+		bool next_chunk(int worker, int &chunk)
+		{
+			if (ranges[worker].pop_front(chunk))
+				return true;
+
+			for(int i=1; i<workers; i++)
+			{
+				if (ranges[(worker + i) % workers].pop_back(chunk))
+					return true;
+			}
+			return false;
+		}
+
+		void copy_chunks()
+		{
+			int c;
+			while((c = next_copy.fetch_add(1)) < chunk_count)
+			{
+				const BatchGS1 &src = *parser.chunks[c];
+				int pos = offsets[c];
+				int n = src.count;
+				int base = c * parser.chunk_scans;
+
+				for(int i=0; i<n; i++)
+					result.scan_index[pos + i] = src.scan_index[i] + base;
+				memcpy(result.body_pos + pos, src.body_pos, n * sizeof(int));
+				memcpy(result.body_len + pos, src.body_len, n * sizeof(short));
+				memcpy(result.ai_id + pos, src.ai_id, n * sizeof(short));
+				memcpy(result.error_code + pos, src.error_code, n * sizeof(unsigned char));
+			}
+		}
+
+		BulkParserGS1 &parser;
+		BatchGS1 &result;
+		const char * const *scans;
+		const int *scan_lens;
+		int scan_count;
+		int chunk_count;
+
+		int workers;
+		std::vector<ChunkRange> ranges;
+
+		bool copying;
+		std::vector<int> offsets;
+		std::atomic<int> next_copy;
+		std::atomic<bool> ok;
+	};
+
+	BulkParserGS1::BulkParserGS1(int threads, int chunk_scans)
+		: chunk_scans((chunk_scans > 0) ? chunk_scans : 1)
+	{
+		if (threads <= 0)
+			threads = (int)std::thread::hardware_concurrency();
+		if (threads <= 0)
+			threads = 1;
+
+		pool = new BulkPool(threads);
+	}
+
+	BulkParserGS1::~BulkParserGS1()
+	{
+		delete pool;
+		for(size_t i=0; i<chunks.size(); i++)
+			delete chunks[i];
+	}
+
+	int BulkParserGS1::GetThreadCount() const
+	{
+		return pool->size();
+	}
+
+	bool BulkParserGS1::ParseGS1(BatchGS1 &result, const char * const *scans, int scan_count)
+	{
+		return ParseGS1(result, scans, 0, scan_count);
+	}
+
+	bool BulkParserGS1::ParseGS1(BatchGS1 &result, const char * const *scans, const int *scan_lens, int scan_count)
+	{
+		int chunk_count = (scan_count + chunk_scans - 1) / chunk_scans;
+		while((int)chunks.size() < chunk_count)
+			chunks.push_back(new BatchGS1());
+
+		BulkParseJob job(*this, result, scans, scan_lens, scan_count, pool->size());
+		pool->run(job);
+		return job.merge(*pool);
+	}
+}
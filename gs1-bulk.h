@@ -0,0 +1,67 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_BULK_H__
+#define __GS1_BULK_H__
+
+#include "gs1-batch.h"
+
+#include <vector>
+
+namespace GS1
+{
+	class BulkPool;
+	class BulkParseJob;
+
+	//Multi-threaded bulk parser.
+	//Scans are split into chunks, every worker starts with its own range of chunks
+	//and steals chunks from the tail of other workers when its range is empty.
+	//The result is merged in scan order, so it is the same as BatchGS1::ParseGS1 for any thread count.
+	//One ParseGS1 call at a time per object; worker threads are kept between calls.
+	class BulkParserGS1
+	{
+	public:
+		explicit BulkParserGS1(int threads = 0, int chunk_scans = 256); //threads = 0: one per CPU core
+		~BulkParserGS1();
+
+		bool ParseGS1(BatchGS1 &result, const char * const *scans, int scan_count);
+		bool ParseGS1(BatchGS1 &result, const char * const *scans, const int *scan_lens, int scan_count);
+
+		int GetThreadCount() const;
+		int GetChunkScans() const { return chunk_scans; }
+
+	protected:
+		friend class BulkParseJob;
+
+		BulkPool *pool;
+		int chunk_scans;
+		std::vector<BatchGS1*> chunks; //per chunk results, kept to reuse the arenas
+
+	private:
+		BulkParserGS1(const BulkParserGS1&);
+		BulkParserGS1& operator=(const BulkParserGS1&);
+	};
+}
+
+#endif
@@ -0,0 +1,457 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-cache.h"
+#include "gs1-spec.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace GS1
+{
+	const int CACHE_WAYS = 4; //entries per set
+	const int SPIN_BEFORE_YIELD = 64;
+
+	void ValueGS1::decode(const FieldAI &field)
+	{
+		if (field.get_date(date))
+			kind = Date;
+		else if (field.get_decimal(decimal))
+			kind = Decimal;
+		else
+			kind = None;
+	}
+
+	static void decode_values(const std::vector<FieldAI> &fields, std::vector<ValueGS1> &values)
+	{
+		values.resize(fields.size());
+		for(size_t i=0; i<fields.size(); i++)
+			values[i].decode(fields[i]);
+	}
+
+	class CacheEntryGS1 : public CachedScanGS1
+	{
+	public:
+		unsigned int version; //get_spec_version() when parsed
+		bool decoded; //values are set
+		bool has_indexed; //indexed is set
+		FieldsGS1 indexed; //for ParseGS1(FieldsGS1&, ...), made on the first such call
+		std::string stream;
+
+		CacheEntryGS1() : version(0), decoded(false), has_indexed(false) { ok = false; }
+
+		void decode()
+		{
+			if (!decoded)
+			{
+				decode_values(fields, values);
+				decoded = true;
+			}
+		}
+	};
+
+	//hot part of an entry, a set of tags is one cache line
+	typedef struct _tag_CacheTag
+	{
+		unsigned long long hash;
+		unsigned long long stamp; //last use, 0 - empty
+	} CacheTag;
+
+	class CacheShardGS1
+	{
+	public:
+		volatile long lock;
+		unsigned long long clock; //stamp source
+		unsigned long long hits;
+		unsigned long long misses;
+
+		CacheTag *tags;
+		CacheEntryGS1 *entries;
+		size_t set_mask; //sets - 1
+
+		char pad[64]; //shards of an array don't share the lock cache line
+
+		CacheShardGS1() : lock(0), clock(0), hits(0), misses(0), tags(0), entries(0), set_mask(0) {}
+		~CacheShardGS1() { delete[] tags; delete[] entries; }
+
+		CacheEntryGS1* find(unsigned long long h, unsigned int version, const char *ptr, int len)
+		{
+			size_t first = (size_t)(h & set_mask) * CACHE_WAYS;
+			for(size_t i=first; i<first + CACHE_WAYS; i++)
+			{
+				if (tags[i].stamp && (tags[i].hash == h))
+				{
+					CacheEntryGS1 &entry = entries[i];
+					if ((entry.version == version) && ((int)entry.stream.length() == len) && !memcmp(entry.stream.data(), ptr, len))
+					{
+						tags[i].stamp = ++clock;
+						return &entry;
+					}
+				}
+			}
+			return 0;
+		}
+
+		//least recently used entry of the set, now owned by h
+		CacheEntryGS1* replace(unsigned long long h, unsigned int version)
+		{
+			size_t first = (size_t)(h & set_mask) * CACHE_WAYS;
+			size_t lru = first;
+			for(size_t i=first + 1; i<first + CACHE_WAYS; i++)
+			{
+				if (tags[i].stamp < tags[lru].stamp)
+					lru = i;
+			}
+			tags[lru].hash = h;
+			tags[lru].stamp = ++clock;
+			entries[lru].version = version;
+			entries[lru].decoded = false;
+			entries[lru].has_indexed = false;
+			return &entries[lru];
+		}
+	};
+
+#ifdef _MSC_VER
+	static inline bool try_lock(volatile long *p) { return _InterlockedCompareExchange(p, 1, 0) == 0; }
+	static inline void unlock(volatile long *p) { _InterlockedExchange(p, 0); }
+	static inline void spin_pause() { _mm_pause(); }
+#else
+	static inline bool try_lock(volatile long *p) { long expected = 0; return __atomic_compare_exchange_n(p, &expected, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED); }
+	static inline void unlock(volatile long *p) { __atomic_store_n(p, 0, __ATOMIC_RELEASE); }
+#if defined(__x86_64__) || defined(__i386__)
+	static inline void spin_pause() { __builtin_ia32_pause(); }
+#else
+	static inline void spin_pause() {}
+#endif
+#endif
+
+	static inline void yield_thread()
+	{
+#ifdef _WIN32
+		SwitchToThread();
+#else
+		sched_yield();
+#endif
+	}
+
+	//shard lock of the concurrent mode, held only for lookups and copies, never while parsing
+	class ShardLock
+	{
+	public:
+		explicit ShardLock(CacheShardGS1 &shard) : shard(shard)
+		{
+			for(int spins=0; !try_lock(&shard.lock); spins++)
+			{
+				if (spins < SPIN_BEFORE_YIELD)
+					spin_pause();
+				else
+					yield_thread(); //owner may be preempted
+			}
+		}
+		~ShardLock() { unlock(&shard.lock); }
+
+	protected:
+		CacheShardGS1 &shard;
+
+	private:
+		ShardLock(const ShardLock&);
+		ShardLock& operator=(const ShardLock&);
+	};
+
+	CacheGS1::CacheGS1()
+		: shards(0), shard_count(0), concurrent(false)
+	{
+	}
+
+	CacheGS1::~CacheGS1()
+	{
+		Close();
+	}
+
+	bool CacheGS1::Create(int capacity, int shards)
+	{
+		Close();
+		if ((capacity <= 0) || (shards < 0))
+			return false;
+
+		int count = shards ? shards : 1;
+		int per_shard = (capacity + count - 1) / count;
+		size_t sets = 1;
+		while((int)sets * CACHE_WAYS < per_shard)
+			sets <<= 1;
+
+		this->shards = new CacheShardGS1[count];
+		for(int i=0; i<count; i++)
+		{
+			this->shards[i].tags = new CacheTag[sets * CACHE_WAYS];
+			memset(this->shards[i].tags, 0, sets * CACHE_WAYS * sizeof(CacheTag));
+			this->shards[i].entries = new CacheEntryGS1[sets * CACHE_WAYS];
+			this->shards[i].set_mask = sets - 1;
+		}
+		shard_count = count;
+		concurrent = (shards > 0);
+		return true;
+	}
+
+	void CacheGS1::Close()
+	{
+		delete[] shards;
+		shards = 0;
+		shard_count = 0;
+		concurrent = false;
+	}
+
+	void CacheGS1::Clear()
+	{
+		for(int i=0; i<shard_count; i++)
+		{
+			CacheShardGS1 &shard = shards[i];
+			size_t n = (shard.set_mask + 1) * CACHE_WAYS;
+			for(size_t k=0; k<n; k++)
+				shard.tags[k].stamp = 0;
+			shard.clock = 0;
+			shard.hits = 0;
+			shard.misses = 0;
+		}
+	}
+
+	int CacheGS1::GetCapacity() const
+	{
+		return shard_count ? (int)((shards[0].set_mask + 1) * CACHE_WAYS) * shard_count : 0;
+	}
+
+	unsigned long long CacheGS1::GetHitCount() const
+	{
+		unsigned long long n = 0;
+		for(int i=0; i<shard_count; i++)
+			n += shards[i].hits;
+		return n;
+	}
+
+	unsigned long long CacheGS1::GetMissCount() const
+	{
+		unsigned long long n = 0;
+		for(int i=0; i<shard_count; i++)
+			n += shards[i].misses;
+		return n;
+	}
+
+	//8 bytes per step, then the fmix64 finalizer of MurmurHash3
+	unsigned long long CacheGS1::hash(const char *ptr, int len)
+	{
+		unsigned long long h = 0x9E3779B97F4A7C15ULL ^ (unsigned long long)len;
+		for(; len >= 8; ptr += 8, len -= 8)
+		{
+			unsigned long long w;
+			memcpy(&w, ptr, 8);
+			h = (h ^ w) * 0xBF58476D1CE4E5B9ULL;
+			h ^= h >> 29;
+		}
+		if (len > 0)
+		{
+			unsigned long long w = 0;
+			memcpy(&w, ptr, len);
+			h = (h ^ w) * 0x94D049BB133111EBULL;
+		}
+
+		h = (h ^ (h >> 33)) * 0xFF51AFD7ED558CCDULL;
+		h = (h ^ (h >> 33)) * 0xC4CEB9FE1A85EC53ULL;
+		return h ^ (h >> 33);
+	}
+
+	bool CacheGS1::ParseGS1(std::vector<FieldAI> &result, std::vector<ValueGS1> *values, const char *gs1_stream, int len, ErrorAI &error)
+	{
+		if (!shard_count)
+		{
+			std::string text(gs1_stream, len);
+			bool ok = parse_gs1(result, text.c_str(), error);
+			if (values)
+				decode_values(result, *values);
+			return ok;
+		}
+
+		if (!concurrent)
+		{
+			const CachedScanGS1 *scan = ParseGS1(gs1_stream, len, values != 0);
+			result = scan->fields;
+			error = scan->error;
+			if (values)
+				*values = scan->values;
+			return scan->ok;
+		}
+
+		unsigned long long h = hash(gs1_stream, len);
+		unsigned int version = get_spec_version();
+		CacheShardGS1 &shard = shards[(size_t)((h >> 32) % (unsigned int)shard_count)];
+
+		{
+			ShardLock lock(shard);
+			CacheEntryGS1 *entry = shard.find(h, version, gs1_stream, len);
+			if (entry)
+			{
+				shard.hits++;
+				result = entry->fields;
+				error = entry->error;
+				if (values)
+				{
+					entry->decode();
+					*values = entry->values;
+				}
+				return entry->ok;
+			}
+			shard.misses++;
+		}
+
+		std::string text(gs1_stream, len); //stream is not NUL terminated
+		bool ok = parse_gs1(result, text.c_str(), error);
+		if (values)
+			decode_values(result, *values);
+
+		ShardLock lock(shard);
+		if (shard.find(h, version, gs1_stream, len))
+			return ok; //added by another thread meanwhile
+
+		CacheEntryGS1 *entry = shard.replace(h, version);
+		entry->ok = ok;
+		entry->stream.swap(text);
+		entry->error = error;
+		entry->fields = result;
+		entry->decoded = (values != 0);
+		if (values)
+			entry->values = *values;
+		return ok;
+	}
+
+	const CachedScanGS1* CacheGS1::ParseGS1(const char *gs1_stream, int len, bool decode)
+	{
+		if (!shard_count || concurrent)
+			return 0;
+
+		unsigned long long h = hash(gs1_stream, len);
+		unsigned int version = get_spec_version();
+		CacheShardGS1 &shard = shards[0];
+
+		CacheEntryGS1 *entry = shard.find(h, version, gs1_stream, len);
+		if (entry)
+			shard.hits++;
+		else
+		{
+			//parse straight into the replaced entry, its buffers are reused
+			shard.misses++;
+			entry = shard.replace(h, version);
+			entry->stream.assign(gs1_stream, len);
+			entry->ok = parse_gs1(entry->fields, entry->stream.c_str(), entry->error);
+		}
+		if (decode)
+			entry->decode();
+		return entry;
+	}
+
+	//new entry from a FieldsGS1 parse of its stream: FieldsGS1 has no error, a failed scan is parsed again for it
+	static void fill_entry(CacheEntryGS1 &entry, const FieldsGS1 &parsed, bool ok, const char *gs1_stream, int len)
+	{
+		entry.stream.assign(gs1_stream, len);
+		entry.ok = ok;
+		if (ok)
+		{
+			int count = parsed.GetCount();
+			entry.fields.resize(count);
+			for(int i=0; i<count; i++)
+				entry.fields[i] = *parsed.Get(i);
+			entry.error.reset(count ? entry.fields[count - 1].reference_pos : 0); //as parse_gs1 leaves it: the last field
+		}
+		else
+			parse_gs1(entry.fields, entry.stream.c_str(), entry.error);
+		entry.indexed = parsed;
+		entry.has_indexed = true;
+	}
+
+	bool CacheGS1::ParseGS1(FieldsGS1 &result, const char *gs1_stream)
+	{
+		if (!shard_count)
+			return result.ParseGS1(gs1_stream);
+
+		int len = (int)strlen(gs1_stream);
+		unsigned long long h = hash(gs1_stream, len);
+		unsigned int version = get_spec_version();
+		CacheShardGS1 &shard = shards[concurrent ? (size_t)((h >> 32) % (unsigned int)shard_count) : 0];
+
+		if (!concurrent)
+		{
+			CacheEntryGS1 *entry = shard.find(h, version, gs1_stream, len);
+			if (entry && entry->has_indexed)
+			{
+				shard.hits++;
+				result = entry->indexed;
+				return entry->ok;
+			}
+
+			//a miss, or a scan cached by the other calls without the index
+			shard.misses++;
+			bool ok = result.ParseGS1(gs1_stream);
+			if (entry)
+			{
+				entry->indexed = result;
+				entry->has_indexed = true;
+			}
+			else
+				fill_entry(*shard.replace(h, version), result, ok, gs1_stream, len);
+			return ok;
+		}
+
+		{
+			ShardLock lock(shard);
+			CacheEntryGS1 *entry = shard.find(h, version, gs1_stream, len);
+			if (entry && entry->has_indexed)
+			{
+				shard.hits++;
+				result = entry->indexed;
+				return entry->ok;
+			}
+			shard.misses++;
+		}
+
+		bool ok = result.ParseGS1(gs1_stream);
+
+		ShardLock lock(shard);
+		CacheEntryGS1 *entry = shard.find(h, version, gs1_stream, len);
+		if (!entry)
+			fill_entry(*shard.replace(h, version), result, ok, gs1_stream, len);
+		else if (!entry->has_indexed)
+		{
+			entry->indexed = result;
+			entry->has_indexed = true;
+		}
+		return ok;
+	}
+}
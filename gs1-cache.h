@@ -0,0 +1,106 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_CACHE_H__
+#define __GS1_CACHE_H__
+
+#include "gs1-parse.h"
+
+namespace GS1
+{
+	//typed decode of one field (FieldAI::get_date/get_decimal)
+	class ValueGS1
+	{
+	public:
+		enum Kind
+		{
+			None = 0, //not a date or decimal AI, or invalid body
+			Date = 1,
+			Decimal = 2
+		};
+
+		Kind kind;
+		DateGS1 date;
+		DecimalGS1 decimal;
+
+		void decode(const FieldAI &field);
+	};
+
+	//one cached scan as parse_gs1() returned it
+	class CachedScanGS1
+	{
+	public:
+		bool ok;
+		ErrorAI error;
+		std::vector<FieldAI> fields;
+		std::vector<ValueGS1> values; //typed decodes of fields, filled only when asked for
+	};
+
+	//Bounded cache of parse results for labels that are scanned again and again (POS, sortation lines).
+	//Keyed by a 64-bit hash of the raw stream, a hit also compares the stream, so results are exactly parse_gs1().
+	//Sets of 4 entries, the least recently used one is replaced. Failed scans are cached too.
+	//Entries made before load_spec()/reset_spec() are not returned.
+	class CacheGS1
+	{
+	public:
+		CacheGS1();
+		~CacheGS1();
+
+		//capacity: scans kept (rounded up to a power of 2 per shard)
+		//shards: 0 - one thread only, no locking; n - n independently locked parts, any number of threads
+		bool Create(int capacity, int shards = 0);
+		void Close();
+		void Clear(); //drop all entries (not with concurrent ParseGS1)
+
+		int GetCapacity() const;
+		unsigned long long GetHitCount() const;
+		unsigned long long GetMissCount() const; //counters are approximate while other threads parse
+
+		//same result and error as parse_gs1(); fields are copied out of the cache
+		bool ParseGS1(std::vector<FieldAI> &result, const char *gs1_stream, ErrorAI &error) { return ParseGS1(result, 0, gs1_stream, (int)strlen(gs1_stream), error); }
+		bool ParseGS1(std::vector<FieldAI> &result, const char *gs1_stream, int len, ErrorAI &error) { return ParseGS1(result, 0, gs1_stream, len, error); }
+		//with values[i] = typed decode of result[i], decoded once per cached scan
+		bool ParseGS1(std::vector<FieldAI> &result, std::vector<ValueGS1> &values, const char *gs1_stream, ErrorAI &error) { return ParseGS1(result, &values, gs1_stream, (int)strlen(gs1_stream), error); }
+		bool ParseGS1(std::vector<FieldAI> &result, std::vector<ValueGS1> *values, const char *gs1_stream, int len, ErrorAI &error);
+
+		//same result as result.ParseGS1(gs1_stream): a hit copies the FieldsGS1 (fields and AI index) kept with the scan
+		bool ParseGS1(FieldsGS1 &result, const char *gs1_stream);
+
+		//one thread mode only (shards 0): the cached scan itself, no copies; valid until the next call, 0 in the concurrent mode
+		const CachedScanGS1* ParseGS1(const char *gs1_stream, int len, bool decode = false);
+
+		static unsigned long long hash(const char *ptr, int len);
+
+	protected:
+		class CacheShardGS1 *shards;
+		int shard_count;
+		bool concurrent;
+
+	private:
+		CacheGS1(const CacheGS1&);
+		CacheGS1& operator=(const CacheGS1&);
+	};
+}
+
+#endif
@@ -0,0 +1,181 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-context.h"
+#include "gs1-stats.h"
+
+#include <string.h>
+#include <new>
+
+namespace GS1
+{
+	class HeapMemoryGS1 : public MemoryGS1
+	{
+	public:
+		void* allocate(size_t size) { return ::operator new(size); }
+		void deallocate(void *ptr, size_t) { ::operator delete(ptr); }
+	};
+
+	MemoryGS1* MemoryGS1::heap()
+	{
+		static HeapMemoryGS1 memory;
+		return &memory;
+	}
+
+	ArenaMemoryGS1::ArenaMemoryGS1(void *block, size_t size, MemoryGS1 *upstream)
+		: block((char*)block), size(size), used(0), upstream(upstream ? upstream : MemoryGS1::heap())
+	{
+	}
+
+	void* ArenaMemoryGS1::allocate(size_t n)
+	{
+		const size_t align = sizeof(void*) > sizeof(long long) ? sizeof(void*) : sizeof(long long);
+		size_t pos = (used + align - 1) & ~(align - 1);
+		if (pos + n > size)
+			return upstream->allocate(n);
+
+		used = pos + n;
+		return block + pos;
+	}
+
+	void ArenaMemoryGS1::deallocate(void *ptr, size_t n)
+	{
+		if (((char*)ptr < block) || ((char*)ptr >= block + size))
+			upstream->deallocate(ptr, n);
+	}
+
+	ContextGS1::ContextGS1(MemoryGS1 *memory)
+		: memory(memory ? memory : MemoryGS1::heap()),
+		fields(0), count(0), fields_capacity(0),
+		text(0), text_capacity(0),
+		ai_index(0), ai_index_size(0)
+	{
+	}
+
+	ContextGS1::~ContextGS1()
+	{
+		if (fields)
+			memory->deallocate(fields, fields_capacity * sizeof(FieldView));
+		if (text)
+			memory->deallocate(text, text_capacity);
+		if (ai_index)
+			memory->deallocate(ai_index, ai_index_size * sizeof(unsigned short));
+	}
+
+	//grows a POD buffer to at least need items, keeping the content
+	void* ContextGS1::grow(void *ptr, int &capacity, int need, size_t item_size)
+	{
+		if (need <= capacity)
+			return ptr;
+
+		int n = (capacity > 0) ? capacity : 8;
+		while(n < need)
+			n *= 2;
+
+		void *p = memory->allocate(n * item_size);
+		if (ptr)
+		{
+			memcpy(p, ptr, capacity * item_size);
+			memory->deallocate(ptr, capacity * item_size);
+		}
+		capacity = n;
+		return p;
+	}
+
+	bool ContextGS1::Reserve(int fields_count, int text_len)
+	{
+		fields = (FieldView*)grow(fields, fields_capacity, fields_count, sizeof(FieldView));
+		text = (char*)grow(text, text_capacity, text_len + 1, 1);
+		return true;
+	}
+
+	const FieldView* ContextGS1::GetByAI(int ai_id) const
+	{
+		if ((ai_id < 0) || (ai_id >= ai_index_size) || !ai_index[ai_id])
+			return 0;
+		return &fields[ai_index[ai_id] - 1];
+	}
+
+	bool ContextGS1::ParseGS1(const char *gs1_stream)
+	{
+		return ParseGS1(gs1_stream, (int)strlen(gs1_stream));
+	}
+
+	bool ContextGS1::ParseGS1(const char *gs1_stream, int len)
+	{
+		GS1_STATS_SCAN(stats);
+
+		//clear only the index entries of the previous scan
+		int ai_count = get_ai_count();
+		if (ai_index_size != ai_count)
+		{
+			if (ai_index)
+				memory->deallocate(ai_index, ai_index_size * sizeof(unsigned short));
+			ai_index = (unsigned short*)memory->allocate(ai_count * sizeof(unsigned short));
+			ai_index_size = ai_count;
+			memset(ai_index, 0, ai_count * sizeof(unsigned short));
+		}
+		else
+		{
+			for(int i=0; i<count; i++)
+			{
+				int id = get_ai_id(fields[i].ai);
+				if (id < 0)
+				{
+					memset(ai_index, 0, ai_count * sizeof(unsigned short)); //parsed with a replaced spec
+					break;
+				}
+				ai_index[id] = 0;
+			}
+		}
+		count = 0;
+
+		//own copy of the scan, views point into it
+		text = (char*)grow(text, text_capacity, len + 1, 1);
+		memcpy(text, gs1_stream, len);
+		text[len] = 0;
+
+		const char *ptr = text;
+		const char *end = text + len;
+		error.reset(0);
+
+		FieldView f;
+		while(ptr < end)
+		{
+			if (!parse_gs1_field(f, text, ptr, end, error))
+				return false;
+
+			fields = (FieldView*)grow(fields, fields_capacity, count + 1, sizeof(FieldView));
+			fields[count++] = f;
+		}
+
+		for(int i=0; i<count; i++)
+		{
+			int id = get_ai_id(fields[i].ai);
+			if (id >= 0)
+				ai_index[id] = (unsigned short)(i + 1);
+		}
+		return true;
+	}
+}
@@ -0,0 +1,128 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_CONTEXT_H__
+#define __GS1_CONTEXT_H__
+
+#include "gs1-parse.h"
+
+#include <stddef.h>
+
+#if defined(__has_include)
+#if __has_include(<memory_resource>) && (__cplusplus >= 201703L)
+#include <memory_resource>
+#define GS1_HAS_PMR
+#endif
+#endif
+
+namespace GS1
+{
+	//Allocation hook of ContextGS1
+	class MemoryGS1
+	{
+	public:
+		virtual ~MemoryGS1() {}
+		virtual void* allocate(size_t size) = 0;
+		virtual void deallocate(void *ptr, size_t size) = 0;
+
+		static MemoryGS1* heap(); //operator new/delete
+	};
+
+	//Monotonic arena over a caller block: deallocate() is a no-op,
+	//requests that don't fit go to the upstream memory (heap by default)
+	class ArenaMemoryGS1 : public MemoryGS1
+	{
+	public:
+		ArenaMemoryGS1(void *block, size_t size, MemoryGS1 *upstream = 0);
+
+		void* allocate(size_t size);
+		void deallocate(void *ptr, size_t size);
+
+		size_t GetUsed() const { return used; }
+
+	protected:
+		char *block;
+		size_t size;
+		size_t used;
+		MemoryGS1 *upstream;
+	};
+
+#ifdef GS1_HAS_PMR
+	class PmrMemoryGS1 : public MemoryGS1
+	{
+	public:
+		explicit PmrMemoryGS1(std::pmr::memory_resource *resource) : resource(resource) {}
+
+		void* allocate(size_t size) { return resource->allocate(size); }
+		void deallocate(void *ptr, size_t size) { resource->deallocate(ptr, size); }
+
+	protected:
+		std::pmr::memory_resource *resource;
+	};
+#endif
+
+	//Reusable parser state: fields, a copy of the scan text and the AI index
+	//keep their capacity between parses, so a hot loop settles at zero allocations.
+	//Results are views into the context's own copy of the scan, valid until the next parse.
+	class ContextGS1
+	{
+	public:
+		explicit ContextGS1(MemoryGS1 *memory = 0); //0 - heap
+		~ContextGS1();
+
+		bool ParseGS1(const char *gs1_stream);
+		bool ParseGS1(const char *gs1_stream, int len);
+
+		int GetCount() const { return count; }
+		const FieldView* Get(int index) const { return ((index >= 0) && (index < count)) ? &fields[index] : 0; }
+		const FieldView* GetByAI(const char *ai) const { return GetByAI(find_ai_id(ai)); }
+		const FieldView* GetByAI(int ai_id) const;
+		const ErrorView& GetError() const { return error; }
+
+		bool Reserve(int fields_count, int text_len);
+
+	protected:
+		void* grow(void *ptr, int &capacity, int need, size_t item_size);
+
+		MemoryGS1 *memory;
+
+		FieldView *fields;
+		int count;
+		int fields_capacity;
+
+		char *text;
+		int text_capacity;
+
+		unsigned short *ai_index; //by AI id: field index + 1
+		int ai_index_size;
+
+		ErrorView error;
+
+	private:
+		ContextGS1(const ContextGS1&);
+		ContextGS1& operator=(const ContextGS1&);
+	};
+}
+
+#endif
@@ -0,0 +1,557 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-dedup.h"
+#include "gs1-simd.h"
+
+#include <string.h>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <xmmintrin.h>
+#define GS1_PREFETCH(p) _mm_prefetch((const char*)(p), _MM_HINT_T0)
+#elif defined(__GNUC__)
+#define GS1_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define GS1_PREFETCH(p) ((void)0)
+#endif
+
+namespace GS1
+{
+	//Table image, the same on the heap and in a file: header, then 64 byte aligned slots.
+	//A slot with w[0] == 0 is empty, BUSY_KEY is a slot being written by InsertConcurrent.
+	static const char DEDUP_MAGIC[8] = {'G', 'S', '1', 'D', 'E', 'D', 'U', 'P'};
+	const unsigned int DEDUP_VERSION = 1;
+	const size_t DEDUP_HEADER_SIZE = 64;
+	const unsigned long long BUSY_KEY = ~0ULL;
+	const int PREFETCH_AHEAD = 8;
+
+	typedef struct _tag_DedupHeader
+	{
+		char magic[8];
+		unsigned int version;
+		unsigned int key_size;
+		unsigned long long slots;
+		unsigned long long count;
+	} DedupHeader;
+
+	//slot word access for the concurrent paths (the table may be a shared file mapping)
+#ifdef _MSC_VER
+	static inline unsigned long long load_acquire(const unsigned long long *p) { return (unsigned long long)_InterlockedCompareExchange64((volatile long long*)p, 0, 0); }
+	static inline void store_release(unsigned long long *p, unsigned long long v) { _InterlockedExchange64((volatile long long*)p, (long long)v); }
+	static inline bool compare_exchange(unsigned long long *p, unsigned long long expected, unsigned long long v) { return (unsigned long long)_InterlockedCompareExchange64((volatile long long*)p, (long long)v, (long long)expected) == expected; }
+	static inline void fetch_add(unsigned long long *p, unsigned long long v) { _InterlockedExchangeAdd64((volatile long long*)p, (long long)v); }
+	static inline void spin_pause() { _mm_pause(); }
+#else
+	static inline unsigned long long load_acquire(const unsigned long long *p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+	static inline void store_release(unsigned long long *p, unsigned long long v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+	static inline bool compare_exchange(unsigned long long *p, unsigned long long expected, unsigned long long v) { return __atomic_compare_exchange_n(p, &expected, v, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); }
+	static inline void fetch_add(unsigned long long *p, unsigned long long v) { __atomic_fetch_add(p, v, __ATOMIC_RELAXED); }
+#if defined(__x86_64__) || defined(__i386__)
+	static inline void spin_pause() { __builtin_ia32_pause(); }
+#else
+	static inline void spin_pause() {}
+#endif
+#endif
+
+	static inline bool same_serial(const DedupKeyGS1 &a, const DedupKeyGS1 &b)
+	{
+		return (a.w[1] == b.w[1]) && (a.w[2] == b.w[2]) && (a.w[3] == b.w[3]);
+	}
+
+	bool DedupKeyGS1::Pack(const char *gtin, const char *serial, int serial_len)
+	{
+		if (!gtin || !serial || (serial_len < 1) || (serial_len > 20) || !isstrdigit(gtin, 14) || memchr(serial, 0, serial_len))
+			return false;
+
+		unsigned long long value = 0;
+		for(int i=0; i<14; i++)
+			value = value * 10 + (unsigned long long)(gtin[i] - '0');
+
+		w[0] = (value + 1) | ((unsigned long long)serial_len << 48); //GTIN < 2^47, never 0 or BUSY_KEY
+		w[1] = w[2] = w[3] = 0;
+		memcpy(&w[1], serial, serial_len);
+		return true;
+	}
+
+	bool DedupKeyGS1::Pack(const TextView &gtin, const TextView &serial)
+	{
+		return (gtin.len == 14) && Pack(gtin.ptr, serial.ptr, serial.len);
+	}
+
+	bool DedupKeyGS1::Pack(const FieldAI &gtin, const FieldAI &serial)
+	{
+		return (gtin.text_body.length() == 14) && Pack(gtin.text_body.c_str(), serial.text_body.c_str(), (int)serial.text_body.length());
+	}
+
+	static inline bool is_ai(const char *text_ai, int len, char c0, char c1)
+	{
+		return (len == 2) && (text_ai[0] == c0) && (text_ai[1] == c1);
+	}
+
+	bool DedupKeyGS1::Pack(const FieldView *fields, int count)
+	{
+		const FieldView *gtin = 0;
+		const FieldView *serial = 0;
+		for(int i=0; i<count; i++)
+		{
+			if (is_ai(fields[i].text_ai.ptr, fields[i].text_ai.len, '0', '1'))
+				gtin = &fields[i];
+			else if (is_ai(fields[i].text_ai.ptr, fields[i].text_ai.len, '2', '1'))
+				serial = &fields[i];
+		}
+		return gtin && serial && Pack(*gtin, *serial);
+	}
+
+	bool DedupKeyGS1::Pack(const std::vector<FieldAI> &fields)
+	{
+		const FieldAI *gtin = 0;
+		const FieldAI *serial = 0;
+		for(size_t i=0; i<fields.size(); i++)
+		{
+			const std::string &ai = fields[i].text_ai;
+			if (is_ai(ai.c_str(), (int)ai.length(), '0', '1'))
+				gtin = &fields[i];
+			else if (is_ai(ai.c_str(), (int)ai.length(), '2', '1'))
+				serial = &fields[i];
+		}
+		return gtin && serial && Pack(*gtin, *serial);
+	}
+
+	unsigned long long DedupKeyGS1::hash() const
+	{
+		unsigned long long h = w[0] ^ (w[1] * 0x9E3779B97F4A7C15ULL);
+		h = (h ^ (h >> 31)) * 0xBF58476D1CE4E5B9ULL;
+		h ^= (w[2] * 0x94D049BB133111EBULL) ^ w[3];
+		h = (h ^ (h >> 29)) * 0xBF58476D1CE4E5B9ULL;
+		return h ^ (h >> 32);
+	}
+
+	//memory-mapped table file
+	class FileGS1
+	{
+	public:
+#ifdef _WIN32
+		HANDLE handle;
+		HANDLE mapping;
+#else
+		int fd;
+#endif
+		void *view;
+		size_t size;
+		bool created; //the file was empty, open() gave it new_size zero bytes
+
+		FileGS1() : view(0), size(0), created(false)
+		{
+#ifdef _WIN32
+			handle = INVALID_HANDLE_VALUE;
+			mapping = 0;
+#else
+			fd = -1;
+#endif
+		}
+
+		~FileGS1() { close(); }
+
+		//maps the whole file, creates it with new_size bytes if it is empty
+		bool open(const char *path, size_t new_size)
+		{
+#ifdef _WIN32
+			handle = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, 0, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+			if (handle == INVALID_HANDLE_VALUE)
+				return false;
+
+			LARGE_INTEGER file_size;
+			if (!GetFileSizeEx(handle, &file_size))
+				return false;
+			size = (size_t)file_size.QuadPart;
+			if (size == 0)
+			{
+				size = new_size;
+				created = true;
+			}
+
+			mapping = CreateFileMappingA(handle, 0, PAGE_READWRITE, (DWORD)((unsigned long long)size >> 32), (DWORD)size, 0);
+			if (!mapping)
+				return false;
+			view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+			return view != 0;
+#else
+			fd = ::open(path, O_RDWR | O_CREAT, 0644);
+			if (fd < 0)
+				return false;
+
+			struct stat st;
+			if (fstat(fd, &st) != 0)
+				return false;
+			size = (size_t)st.st_size;
+			if (size == 0)
+			{
+				size = new_size;
+				if (ftruncate(fd, (off_t)size) != 0) //sparse, reads as zeros
+					return false;
+				created = true;
+			}
+
+			view = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			if (view == MAP_FAILED)
+			{
+				view = 0;
+				return false;
+			}
+			return true;
+#endif
+		}
+
+		bool flush()
+		{
+#ifdef _WIN32
+			return view && FlushViewOfFile(view, 0) && FlushFileBuffers(handle);
+#else
+			return view && (msync(view, size, MS_SYNC) == 0);
+#endif
+		}
+
+		void close()
+		{
+#ifdef _WIN32
+			if (view)
+				UnmapViewOfFile(view);
+			if (mapping)
+				CloseHandle(mapping);
+			if (handle != INVALID_HANDLE_VALUE)
+				CloseHandle(handle);
+			handle = INVALID_HANDLE_VALUE;
+			mapping = 0;
+#else
+			if (view)
+				munmap(view, size);
+			if (fd >= 0)
+				::close(fd);
+			fd = -1;
+#endif
+			view = 0;
+			size = 0;
+		}
+	};
+
+	//power of two slots for capacity keys at 3/4 load
+	static size_t slots_for(size_t capacity)
+	{
+		size_t n = 16;
+		while(n / 4 * 3 < capacity)
+			n *= 2;
+		return n;
+	}
+
+	static inline size_t image_size(size_t slots)
+	{
+		return DEDUP_HEADER_SIZE + slots * sizeof(DedupKeyGS1);
+	}
+
+	static void init_header(void *memory, size_t slots)
+	{
+		DedupHeader *header = (DedupHeader*)memory;
+		memcpy(header->magic, DEDUP_MAGIC, sizeof(header->magic));
+		header->version = DEDUP_VERSION;
+		header->key_size = sizeof(DedupKeyGS1);
+		header->slots = slots;
+		header->count = 0;
+	}
+
+	DedupGS1::DedupGS1()
+		: file(0), count(0), slots(0), mask(0), max_count(0), heap(0)
+	{
+	}
+
+	DedupGS1::~DedupGS1()
+	{
+		Close();
+	}
+
+	bool DedupGS1::attach(void *memory, size_t slot_count)
+	{
+		DedupHeader *header = (DedupHeader*)memory;
+		count = &header->count;
+		slots = (DedupKeyGS1*)((char*)memory + DEDUP_HEADER_SIZE);
+		mask = slot_count - 1;
+		max_count = slot_count / 4 * 3;
+		return true;
+	}
+
+	static void* allocate_image(size_t slots)
+	{
+		//64 byte aligned, so a slot never crosses a cache line
+		size_t size = image_size(slots) + 64 + sizeof(void*);
+		char *raw = (char*)::operator new(size, std::nothrow);
+		if (!raw)
+			return 0;
+		memset(raw, 0, size);
+
+		char *image = (char*)(((size_t)raw + sizeof(void*) + 63) & ~(size_t)63);
+		((void**)image)[-1] = raw; //for free_image()
+		return image;
+	}
+
+	static void free_image(void *image)
+	{
+		if (image)
+			::operator delete(((void**)image)[-1]);
+	}
+
+	bool DedupGS1::Create(size_t capacity)
+	{
+		Close();
+
+		size_t slot_count = slots_for(capacity);
+		heap = allocate_image(slot_count);
+		if (!heap)
+			return false;
+
+		init_header(heap, slot_count);
+		return attach(heap, slot_count);
+	}
+
+	bool DedupGS1::Open(const char *path, size_t capacity)
+	{
+		Close();
+
+		size_t slot_count = slots_for(capacity);
+		file = new FileGS1();
+		if (!file->open(path, image_size(slot_count)))
+		{
+			Close();
+			return false;
+		}
+
+		DedupHeader *header = (DedupHeader*)file->view;
+		if (file->created)
+			init_header(header, slot_count); //an existing file is only read until it passes the checks below
+
+		if (file->size < DEDUP_HEADER_SIZE)
+		{
+			Close();
+			return false;
+		}
+		slot_count = (size_t)header->slots;
+		if (memcmp(header->magic, DEDUP_MAGIC, sizeof(header->magic)) ||
+			(header->version != DEDUP_VERSION) || (header->key_size != sizeof(DedupKeyGS1)) ||
+			(slot_count < 16) || (slot_count & (slot_count - 1)) || (image_size(slot_count) != file->size))
+		{
+			Close(); //not a table of this version
+			return false;
+		}
+
+		return attach(file->view, slot_count);
+	}
+
+	bool DedupGS1::Flush()
+	{
+		return !file || file->flush();
+	}
+
+	void DedupGS1::Close()
+	{
+		delete file;
+		file = 0;
+		free_image(heap);
+		heap = 0;
+
+		count = 0;
+		slots = 0;
+		mask = 0;
+		max_count = 0;
+	}
+
+	size_t DedupGS1::GetCount() const
+	{
+		return count ? (size_t)load_acquire(count) : 0;
+	}
+
+	size_t DedupGS1::GetCapacity() const
+	{
+		return max_count;
+	}
+
+	//rehash into twice the slots (heap tables only)
+	bool DedupGS1::grow()
+	{
+		if (!heap)
+			return false;
+
+		size_t slot_count = (mask + 1) * 2;
+		void *image = allocate_image(slot_count);
+		if (!image)
+			return false;
+
+		init_header(image, slot_count);
+		DedupKeyGS1 *to = (DedupKeyGS1*)((char*)image + DEDUP_HEADER_SIZE);
+		size_t to_mask = slot_count - 1;
+		for(size_t i=0; i<=mask; i++)
+		{
+			if (!slots[i].w[0])
+				continue;
+
+			size_t j = (size_t)slots[i].hash() & to_mask;
+			while(to[j].w[0])
+				j = (j + 1) & to_mask;
+			to[j] = slots[i];
+		}
+		((DedupHeader*)image)->count = *count;
+
+		free_image(heap);
+		heap = image;
+		return attach(heap, slot_count);
+	}
+
+	int DedupGS1::Insert(const DedupKeyGS1 &key)
+	{
+		if (!slots)
+			return Full;
+		if ((*count >= max_count) && !grow())
+			return Full;
+
+		size_t i = (size_t)key.hash() & mask;
+		for(;;)
+		{
+			DedupKeyGS1 &slot = slots[i];
+			if (!slot.w[0])
+			{
+				slot.w[1] = key.w[1];
+				slot.w[2] = key.w[2];
+				slot.w[3] = key.w[3];
+				store_release(&slot.w[0], key.w[0]);
+				(*count)++;
+				return Inserted;
+			}
+			if ((slot.w[0] == key.w[0]) && same_serial(slot, key))
+				return Duplicate;
+			i = (i + 1) & mask;
+		}
+	}
+
+	//claims an empty slot with a CAS to BUSY_KEY, writes the serial, then publishes w[0];
+	//a thread meeting a BUSY_KEY slot waits for it, so the same key is never inserted twice
+	int DedupGS1::InsertConcurrent(const DedupKeyGS1 &key)
+	{
+		if (!slots || (load_acquire(count) >= max_count))
+			return Full;
+
+		size_t i = (size_t)key.hash() & mask;
+		for(;;)
+		{
+			DedupKeyGS1 &slot = slots[i];
+			unsigned long long w0 = load_acquire(&slot.w[0]);
+			if (!w0)
+			{
+				if (!compare_exchange(&slot.w[0], 0, BUSY_KEY))
+					continue; //lost the slot, look at it again
+				slot.w[1] = key.w[1];
+				slot.w[2] = key.w[2];
+				slot.w[3] = key.w[3];
+				store_release(&slot.w[0], key.w[0]);
+				fetch_add(count, 1);
+				return Inserted;
+			}
+			if (w0 == BUSY_KEY)
+			{
+				spin_pause();
+				continue;
+			}
+			if ((w0 == key.w[0]) && same_serial(slot, key))
+				return Duplicate;
+			i = (i + 1) & mask;
+		}
+	}
+
+	bool DedupGS1::Contains(const DedupKeyGS1 &key) const
+	{
+		if (!slots)
+			return false;
+
+		size_t i = (size_t)key.hash() & mask;
+		for(;;)
+		{
+			const DedupKeyGS1 &slot = slots[i];
+			unsigned long long w0 = load_acquire(&slot.w[0]);
+			if (!w0)
+				return false;
+			if (w0 == BUSY_KEY)
+			{
+				spin_pause();
+				continue;
+			}
+			if ((w0 == key.w[0]) && same_serial(slot, key))
+				return true;
+			i = (i + 1) & mask;
+		}
+	}
+
+	int DedupGS1::Contains(const DedupKeyGS1 *keys, int key_count, bool *seen) const
+	{
+		if (!slots)
+		{
+			for(int k=0; k<key_count; k++)
+				seen[k] = false;
+			return 0;
+		}
+
+		int found = 0;
+		for(int k=0; k<key_count; k++)
+		{
+			if (k + PREFETCH_AHEAD < key_count)
+				GS1_PREFETCH(&slots[(size_t)keys[k + PREFETCH_AHEAD].hash() & mask]);
+
+			seen[k] = Contains(keys[k]);
+			if (seen[k])
+				found++;
+		}
+		return found;
+	}
+
+	int DedupGS1::Insert(const DedupKeyGS1 *keys, int key_count, unsigned char *results)
+	{
+		int inserted = 0;
+		for(int k=0; k<key_count; k++)
+		{
+			if (slots && (k + PREFETCH_AHEAD < key_count))
+				GS1_PREFETCH(&slots[(size_t)keys[k + PREFETCH_AHEAD].hash() & mask]);
+
+			results[k] = (unsigned char)Insert(keys[k]);
+			if (results[k] == Inserted)
+				inserted++;
+		}
+		return inserted;
+	}
+}
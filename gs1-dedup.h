@@ -0,0 +1,113 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_DEDUP_H__
+#define __GS1_DEDUP_H__
+
+#include "gs1-parse.h"
+
+#include <stddef.h>
+
+namespace GS1
+{
+	//(GTIN-14, serial) packed into 32 bytes: GTIN value and serial length, then the serial zero-padded
+	class DedupKeyGS1
+	{
+	public:
+		unsigned long long w[4];
+
+		//false: GTIN is not 14 digits or serial is not 1..20 chars (or has NUL)
+		bool Pack(const char *gtin, const char *serial, int serial_len);
+		bool Pack(const FieldView &gtin, const FieldView &serial) { return Pack(gtin.text_body, serial.text_body); }
+		bool Pack(const FieldAI &gtin, const FieldAI &serial);
+		bool Pack(const TextView &gtin, const TextView &serial);
+
+		//finds AI 01 and 21 in one parsed scan
+		bool Pack(const FieldView *fields, int count);
+		bool Pack(const std::vector<FieldAI> &fields);
+
+		unsigned long long hash() const;
+	};
+
+	//Open-addressing (linear probing) set of (GTIN, serial) keys for duplicate detection.
+	//Slots are the packed keys themselves, so a lookup touches one or two cache lines.
+	//The table lives on the heap (Create) or in a memory-mapped file (Open), which keeps it between runs.
+	class DedupGS1
+	{
+	public:
+		enum Result
+		{
+			Inserted = 0,
+			Duplicate = 1,
+			Invalid = 2, //no 01/21 or invalid key
+			Full = 3 //fixed capacity reached (file or concurrent insert)
+		};
+
+		DedupGS1();
+		~DedupGS1();
+
+		//capacity: expected keys; a heap table grows by Insert() when needed
+		bool Create(size_t capacity);
+		//file-backed table, capacity is used when the file is created; existing files keep theirs
+		bool Open(const char *path, size_t capacity);
+		bool Flush(); //write a file-backed table to disk
+		void Close();
+
+		size_t GetCount() const;
+		size_t GetCapacity() const; //keys before Full (or growth)
+
+		//single writer
+		int Insert(const DedupKeyGS1 &key);
+		int Insert(const FieldView *fields, int count) { DedupKeyGS1 key; return key.Pack(fields, count) ? Insert(key) : Invalid; }
+		int Insert(const std::vector<FieldAI> &fields) { DedupKeyGS1 key; return key.Pack(fields) ? Insert(key) : Invalid; }
+
+		//any number of threads with each other and Contains(); never grows the table
+		int InsertConcurrent(const DedupKeyGS1 &key);
+		int InsertConcurrent(const FieldView *fields, int count) { DedupKeyGS1 key; return key.Pack(fields, count) ? InsertConcurrent(key) : Invalid; }
+
+		bool Contains(const DedupKeyGS1 &key) const;
+
+		//bulk "seen before?": seen[i] = Contains(keys[i]), slots are prefetched ahead; returns the number seen
+		int Contains(const DedupKeyGS1 *keys, int count, bool *seen) const;
+		//bulk insert, results[i] = Result
+		int Insert(const DedupKeyGS1 *keys, int count, unsigned char *results);
+
+	protected:
+		bool attach(void *memory, size_t slots);
+		bool grow();
+
+		class FileGS1 *file;
+		unsigned long long *count; //in the header
+		DedupKeyGS1 *slots;
+		size_t mask; //slots - 1
+		size_t max_count;
+		void *heap; //Create()
+
+	private:
+		DedupGS1(const DedupGS1&);
+		DedupGS1& operator=(const DedupGS1&);
+	};
+}
+
+#endif
@@ -0,0 +1,122 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-encode.h"
+
+#include <string.h>
+
+namespace GS1
+{
+	static int encode_error(ErrorView &error, ErrorAI::ErrorCode code, int index, const AI *ai, const char *ai_code)
+	{
+		error.code = code;
+		error.ai = ai;
+		error.text_ai = ai_code ? TextView(ai_code, (int)strlen(ai_code)) : TextView();
+		error.reference_pos = index;
+		return -1;
+	}
+
+	static const AI* check_element(const ElementGS1 &e, int index, int &value_len, ErrorView &error)
+	{
+		const AI *ai = e.ai ? get_ai(e.ai) : 0;
+		int ai_len = ai ? (int)strlen(ai->ai) : 0;
+		bool code_ok = ai && ((int)strlen(e.ai) == ai_len);
+		for(int k=0; code_ok && (k<ai_len); k++)
+		{
+			if ((ai->ai[k] == 'n') && ((unsigned char)(e.ai[k] - '0') > 9))
+				code_ok = false; //decimal point position must be a digit
+		}
+		if (!code_ok)
+		{
+			encode_error(error, ErrorAI::UnknownAI, index, ai, e.ai);
+			return 0;
+		}
+
+		value_len = e.value ? ((e.value_len >= 0) ? e.value_len : (int)strlen(e.value)) : 0;
+
+		int body_min = ai->field_len - ai_len;
+		int body_max = (ai->max_field_len_optional > 0) ? ai->max_field_len_optional - ai_len : body_min;
+		if (body_min <= 0)
+			encode_error(error, ErrorAI::InvalidSpecLen, index, ai, e.ai);
+		else if (value_len == 0)
+			encode_error(error, ErrorAI::EmptyBody, index, ai, e.ai);
+		else if (value_len < body_min)
+			encode_error(error, ErrorAI::BodyTooShort, index, ai, e.ai);
+		else if (value_len > body_max)
+			encode_error(error, ErrorAI::BodyTooLong, index, ai, e.ai);
+		else if (memchr(e.value, GS1::FNC1, value_len) || memchr(e.value, 0, value_len))
+			encode_error(error, ErrorAI::InvalidChar, index, ai, e.ai);
+		else
+			return ai;
+		return 0;
+	}
+
+	int encode_gs1(char *buf, int buf_size, const ElementGS1 *elements, int count, ErrorView &error, int flags)
+	{
+		error.reset(0);
+
+		int value_len;
+		for(int i=0; i<count; i++)
+		{
+			if (!check_element(elements[i], i, value_len, error))
+				return -1;
+		}
+
+		char *p = buf;
+		char *end = buf + buf_size;
+		bool pending_fnc1 = false; //previous field is FNC1_required
+
+		//pass 0: AIs without FNC1, pass 1: FNC1_required AIs (single pass when keeping the order)
+		int passes = (flags & ENCODE_KEEP_ORDER) ? 1 : 2;
+		for(int pass=0; pass<passes; pass++)
+		{
+			for(int i=0; i<count; i++)
+			{
+				const ElementGS1 &e = elements[i];
+				const AI *ai = get_ai(e.ai);
+				if ((passes == 2) && (ai->FNC1_required != (pass == 1)))
+					continue;
+
+				value_len = (e.value_len >= 0) ? e.value_len : (int)strlen(e.value);
+				int ai_len = (int)strlen(e.ai);
+				int need = (pending_fnc1 ? 1 : 0) + ai_len + value_len;
+				if (end - p < need)
+					return encode_error(error, ErrorAI::BufferTooSmall, i, ai, e.ai);
+
+				if (pending_fnc1)
+					*p++ = GS1::FNC1;
+				memcpy(p, e.ai, ai_len);
+				p += ai_len;
+				memcpy(p, e.value, value_len);
+				p += value_len;
+
+				pending_fnc1 = ai->FNC1_required;
+			}
+		}
+
+		if (p < end)
+			*p = 0;
+		return (int)(p - buf);
+	}
+}
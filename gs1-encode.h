@@ -0,0 +1,54 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_ENCODE_H__
+#define __GS1_ENCODE_H__
+
+#include "gs1-parse.h"
+
+namespace GS1
+{
+	class ElementGS1
+	{
+	public:
+		const char *ai; //full AI code, e.g. "01" or "3102"
+		const char *value;
+		int value_len; //-1: NUL-terminated value
+
+		ElementGS1() : ai(0), value(0), value_len(-1) {}
+		ElementGS1(const char *ai, const char *value, int value_len = -1) : ai(ai), value(value), value_len(value_len) {}
+	};
+
+	const int ENCODE_KEEP_ORDER = 1; //write elements in the given order
+
+	//Builds the element string (FNC1-separated) into buf, without allocations.
+	//Values are checked against field_len/max_field_len_optional of the spec.
+	//Unless ENCODE_KEEP_ORDER is set, AIs without FNC1_required go first (they never need a separator)
+	//and the last FNC1_required one ends the string, which keeps the number of FNC1 separators minimal.
+	//Returns the length (a NUL is added if there is room) or -1; error.reference_pos is the element index.
+	int encode_gs1(char *buf, int buf_size, const ElementGS1 *elements, int count, ErrorView &error, int flags = 0);
+	inline int encode_gs1(char *buf, int buf_size, const ElementGS1 *elements, int count, int flags = 0) { ErrorView error; return encode_gs1(buf, buf_size, elements, count, error, flags); }
+}
+
+#endif
@@ -0,0 +1,341 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-format.h"
+
+#include <string.h>
+
+namespace GS1
+{
+	static const char digits_00_99[] =
+		"00010203040506070809"
+		"10111213141516171819"
+		"20212223242526272829"
+		"30313233343536373839"
+		"40414243444546474849"
+		"50515253545556575859"
+		"60616263646566676869"
+		"70717273747576777879"
+		"80818283848586878889"
+		"90919293949596979899";
+
+	int format_uint(char *buf, unsigned long long value)
+	{
+		char tmp[20];
+		char *p = tmp + sizeof(tmp);
+		while(value >= 100)
+		{
+			const char *d = digits_00_99 + (value % 100) * 2;
+			value /= 100;
+			*--p = d[1];
+			*--p = d[0];
+		}
+		if (value >= 10)
+		{
+			const char *d = digits_00_99 + value * 2;
+			*--p = d[1];
+			*--p = d[0];
+		}
+		else
+			*--p = (char)('0' + value);
+
+		int len = (int)(tmp + sizeof(tmp) - p);
+		memcpy(buf, p, len);
+		return len;
+	}
+
+	int format_decimal(char *buf, const DecimalGS1 &value)
+	{
+		char *p = buf;
+		unsigned long long m = (unsigned long long)value.mantissa;
+		if (value.mantissa < 0)
+		{
+			*p++ = '-';
+			m = 0 - m;
+		}
+
+		char digits[20];
+		int len = format_uint(digits, m);
+		int decimals = -value.exponent;
+		if (decimals <= 0)
+		{
+			memcpy(p, digits, len);
+			p += len;
+			while(decimals++ < 0)
+				*p++ = '0';
+		}
+		else if (len <= decimals)
+		{
+			//0.000ddd
+			*p++ = '0';
+			*p++ = '.';
+			for(int i=len; i<decimals; i++)
+				*p++ = '0';
+			memcpy(p, digits, len);
+			p += len;
+		}
+		else
+		{
+			memcpy(p, digits, len - decimals);
+			p += len - decimals;
+			*p++ = '.';
+			memcpy(p, digits + len - decimals, decimals);
+			p += decimals;
+		}
+		return (int)(p - buf);
+	}
+
+	static inline void put2(char *p, int value)
+	{
+		p[0] = digits_00_99[value * 2];
+		p[1] = digits_00_99[value * 2 + 1];
+	}
+
+	int format_date(char *buf, const DateGS1 &value, bool ISO_date)
+	{
+		int cc = (value.year / 100) % 100;
+		int yy = value.year % 100;
+		if (ISO_date)
+		{
+			put2(buf, cc); put2(buf + 2, yy); buf[4] = '-';
+			put2(buf + 5, value.month); buf[7] = '-';
+			put2(buf + 8, value.day);
+		}
+		else
+		{
+			put2(buf, value.day); buf[2] = '-';
+			put2(buf + 3, value.month); buf[5] = '-';
+			put2(buf + 6, cc); put2(buf + 8, yy);
+		}
+		return 10;
+	}
+
+	//uniform access to FieldAI and FieldView
+	static inline TextView text_ai_of(const FieldView &f) { return f.text_ai; }
+	static inline TextView text_body_of(const FieldView &f) { return f.text_body; }
+	static inline TextView text_ai_of(const FieldAI &f) { return TextView(f.text_ai.data(), (int)f.text_ai.length()); }
+	static inline TextView text_body_of(const FieldAI &f) { return TextView(f.text_body.data(), (int)f.text_body.length()); }
+
+	static inline void append(std::string &out, const TextView &text)
+	{
+		out.append(text.ptr, text.len);
+	}
+
+	static void append_json_string(std::string &out, const char *ptr, int len)
+	{
+		static const char hex[] = "0123456789abcdef";
+
+		out.push_back('"');
+		const char *end = ptr + len;
+		while(ptr < end)
+		{
+			//copy the run of plain chars at once
+			const char *run = ptr;
+			while((ptr < end) && ((unsigned char)*ptr >= 0x20) && ((unsigned char)*ptr < 0x80) && (*ptr != '"') && (*ptr != '\\'))
+				ptr++;
+			out.append(run, ptr - run);
+			if (ptr == end)
+				break;
+
+			unsigned char c = (unsigned char)*ptr++;
+			if ((c == '"') || (c == '\\'))
+			{
+				out.push_back('\\');
+				out.push_back((char)c);
+			}
+			else
+			{
+				//control chars and 8-bit (Latin-1) chars of spec titles
+				char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 15]};
+				out.append(esc, 6);
+			}
+		}
+		out.push_back('"');
+	}
+
+	static void append_csv_value(std::string &out, const char *ptr, int len)
+	{
+		const char *end = ptr + len;
+		bool quote = false;
+		for(const char *p = ptr; p < end; p++)
+		{
+			if ((*p == ',') || (*p == '"') || (*p == '\r') || (*p == '\n'))
+			{
+				quote = true;
+				break;
+			}
+		}
+
+		if (!quote)
+		{
+			out.append(ptr, len);
+			return;
+		}
+
+		out.push_back('"');
+		for(const char *p = ptr; p < end; p++)
+		{
+			if (*p == '"')
+				out.push_back('"');
+			out.push_back(*p);
+		}
+		out.push_back('"');
+	}
+
+	//formatted value: 0 - raw text, 1 - number in buf, 2 - date text in buf
+	template<class F>
+	static int format_value(const F &f, int flags, char *buf, int &len, DecimalGS1 &dec)
+	{
+		if (!(flags & FORMAT_RAW) && f.ai)
+		{
+			DateGS1 date;
+			if ((f.ai->data_format == GS1_DATE) && f.get_date(date))
+			{
+				len = format_date(buf, date, true);
+				return 2;
+			}
+			if ((f.ai->data_format == GS1_DECIMAL) && f.get_decimal(dec))
+			{
+				len = format_decimal(buf, dec);
+				return 1;
+			}
+		}
+		return 0;
+	}
+
+	//grow only: before C++20 reserve() below the capacity may shrink a buffer reused across scans
+	static inline void reserve_more(std::string &out, size_t extra)
+	{
+		if (out.length() + extra > out.capacity())
+			out.reserve(out.length() + extra);
+	}
+
+	template<class F>
+	static void format_json_fields(std::string &out, const F *fields, int count, int flags)
+	{
+		reserve_more(out, 2 + count * 64);
+		out.push_back('[');
+		for(int i=0; i<count; i++)
+		{
+			const F &f = fields[i];
+			if (i > 0)
+				out.push_back(',');
+
+			out.append("{\"ai\":\"", 7);
+			append(out, text_ai_of(f));
+			out.push_back('"');
+
+			if ((flags & FORMAT_TITLES) && f.ai && f.ai->data_title)
+			{
+				out.append(",\"title\":", 9);
+				append_json_string(out, f.ai->data_title, (int)strlen(f.ai->data_title));
+			}
+
+			out.append(",\"value\":", 9);
+
+			char buf[32];
+			int len;
+			DecimalGS1 dec;
+			switch(format_value(f, flags, buf, len, dec))
+			{
+			case 1:
+				out.append(buf, len);
+				if (dec.currency >= 0)
+				{
+					out.append(",\"currency\":\"", 13);
+					char cur[3];
+					cur[0] = (char)('0' + dec.currency / 100);
+					put2(cur + 1, dec.currency % 100);
+					out.append(cur, 3);
+					out.push_back('"');
+				}
+				break;
+			case 2:
+				out.push_back('"');
+				out.append(buf, len);
+				out.push_back('"');
+				break;
+			default:
+				{
+					TextView body = text_body_of(f);
+					append_json_string(out, body.ptr, body.len);
+				}
+				break;
+			}
+			out.push_back('}');
+		}
+		out.push_back(']');
+	}
+
+	template<class F>
+	static void format_csv_fields(std::string &out, const F *fields, int count, int flags)
+	{
+		reserve_more(out, count * 48);
+		for(int i=0; i<count; i++)
+		{
+			const F &f = fields[i];
+			append(out, text_ai_of(f));
+			out.push_back(',');
+
+			char buf[32];
+			int len;
+			DecimalGS1 dec;
+			if (format_value(f, flags, buf, len, dec))
+				out.append(buf, len);
+			else
+			{
+				TextView body = text_body_of(f);
+				append_csv_value(out, body.ptr, body.len);
+			}
+
+			if (flags & FORMAT_TITLES)
+			{
+				out.push_back(',');
+				if (f.ai && f.ai->data_title)
+					append_csv_value(out, f.ai->data_title, (int)strlen(f.ai->data_title));
+			}
+			out.append("\r\n", 2);
+		}
+	}
+
+	template<class F>
+	static void format_hri_fields(std::string &out, const F *fields, int count)
+	{
+		reserve_more(out, count * 32);
+		for(int i=0; i<count; i++)
+		{
+			out.push_back('(');
+			append(out, text_ai_of(fields[i]));
+			out.push_back(')');
+			append(out, text_body_of(fields[i]));
+		}
+	}
+
+	void format_json(std::string &out, const FieldView *fields, int count, int flags) { format_json_fields(out, fields, count, flags); }
+	void format_json(std::string &out, const FieldAI *fields, int count, int flags) { format_json_fields(out, fields, count, flags); }
+	void format_csv(std::string &out, const FieldView *fields, int count, int flags) { format_csv_fields(out, fields, count, flags); }
+	void format_csv(std::string &out, const FieldAI *fields, int count, int flags) { format_csv_fields(out, fields, count, flags); }
+	void format_hri(std::string &out, const FieldView *fields, int count) { format_hri_fields(out, fields, count); }
+	void format_hri(std::string &out, const FieldAI *fields, int count) { format_hri_fields(out, fields, count); }
+}
@@ -0,0 +1,72 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_FORMAT_H__
+#define __GS1_FORMAT_H__
+
+#include "gs1-parse.h"
+
+#include <string>
+#include <vector>
+
+namespace GS1
+{
+	//Serializers append to out, so a reused out string does not allocate after warm-up.
+	//Dates are written as YYYY-MM-DD and decimals as exact fixed point numbers,
+	//other bodies (and all bodies with FORMAT_RAW) as they are.
+
+	const int FORMAT_TITLES = 1; //add AI::data_title
+	const int FORMAT_RAW = 2; //no date/decimal conversion
+
+	//[{"ai":"01","title":"GTIN","value":"00614141999996"},{"ai":"3102","value":12.34}]
+	//391n/393n add "currency":"978"
+	void format_json(std::string &out, const FieldView *fields, int count, int flags = 0);
+	void format_json(std::string &out, const FieldAI *fields, int count, int flags = 0);
+
+	//one RFC 4180 record per field: AI,value[,title] CRLF
+	void format_csv(std::string &out, const FieldView *fields, int count, int flags = 0);
+	void format_csv(std::string &out, const FieldAI *fields, int count, int flags = 0);
+
+	//bracketed human readable form: (01)00614141999996(10)ABCDEF123456, bodies are always raw
+	void format_hri(std::string &out, const FieldView *fields, int count);
+	void format_hri(std::string &out, const FieldAI *fields, int count);
+
+	inline void format_json(std::string &out, const std::vector<FieldView> &fields, int flags = 0) { format_json(out, fields.empty() ? 0 : &fields[0], (int)fields.size(), flags); }
+	inline void format_json(std::string &out, const std::vector<FieldAI> &fields, int flags = 0) { format_json(out, fields.empty() ? 0 : &fields[0], (int)fields.size(), flags); }
+	inline void format_csv(std::string &out, const std::vector<FieldView> &fields, int flags = 0) { format_csv(out, fields.empty() ? 0 : &fields[0], (int)fields.size(), flags); }
+	inline void format_csv(std::string &out, const std::vector<FieldAI> &fields, int flags = 0) { format_csv(out, fields.empty() ? 0 : &fields[0], (int)fields.size(), flags); }
+	inline void format_hri(std::string &out, const std::vector<FieldView> &fields) { format_hri(out, fields.empty() ? 0 : &fields[0], (int)fields.size()); }
+	inline void format_hri(std::string &out, const std::vector<FieldAI> &fields) { format_hri(out, fields.empty() ? 0 : &fields[0], (int)fields.size()); }
+
+	inline void format_json(std::string &out, const FieldsGS1 &gs1, int flags = 0) { format_json(out, gs1.Get(0), gs1.GetCount(), flags); }
+	inline void format_csv(std::string &out, const FieldsGS1 &gs1, int flags = 0) { format_csv(out, gs1.Get(0), gs1.GetCount(), flags); }
+	inline void format_hri(std::string &out, const FieldsGS1 &gs1) { format_hri(out, gs1.Get(0), gs1.GetCount()); }
+
+	//number/date writers used by the serializers, return chars written
+	int format_uint(char *buf, unsigned long long value); //buf: 20 chars
+	int format_decimal(char *buf, const DecimalGS1 &value); //buf: 24 chars, exact, e.g. 12.34 or 0.00001
+	int format_date(char *buf, const DateGS1 &value, bool ISO_date); //buf: 10 chars, YYYY-MM-DD or DD-MM-YYYY
+}
+
+#endif
@@ -0,0 +1,148 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-hri.h"
+#include "gs1-simd.h"
+#include "gs1-stats.h"
+
+#include <string.h>
+
+namespace GS1
+{
+	static bool hri_error(ErrorView &error, ErrorAI::ErrorCode code, const AI *ai, const TextView &text_ai)
+	{
+		GS1_STATS_ERROR(code);
+		error.code = code;
+		error.ai = ai;
+		error.text_ai = text_ai;
+		return false;
+	}
+
+	//"(AI)" at ptr: returns the spec entry and moves ptr after ')'
+	static const AI* hri_ai(const char *&ptr, const char *end, TextView &text_ai, const HotAI *&hot)
+	{
+		const char *code = ptr + 1;
+		const char *close = code;
+		while((close < end) && (close - code <= 4) && (*close != ')'))
+			close++;
+
+		text_ai = TextView(code, (int)(close - code));
+		if ((close >= end) || (*close != ')'))
+			return 0;
+
+		const AI *ai = get_ai_exact(code, text_ai.len, hot);
+		if (ai)
+			ptr = close + 1;
+		return ai;
+	}
+
+	//the next '(' that opens a known AI, or end
+	static const char* hri_value_end(const char *ptr, const char *end)
+	{
+		for(;;)
+		{
+			ptr = find_byte(ptr, end, '(');
+			if (ptr == end)
+				return end;
+
+			const char *next = ptr;
+			TextView text_ai;
+			const HotAI *hot;
+			if (hri_ai(next, end, text_ai, hot))
+				return ptr;
+			ptr++;
+		}
+	}
+
+	bool parse_hri(std::vector<FieldView> &result, const char *hri, int len, ErrorView &error)
+	{
+		GS1_STATS_SCAN(stats);
+		result.clear();
+
+		const char *ptr = hri;
+		const char *end = hri + len;
+
+		FieldView f;
+		while(ptr < end)
+		{
+			const char *start = ptr;
+			error.reset(start - hri);
+
+			TextView text_ai;
+			const HotAI *hot = 0;
+			const AI *ai = (*ptr == '(') ? hri_ai(ptr, end, text_ai, hot) : 0;
+			if (!ai)
+				return hri_error(error, ErrorAI::UnknownAI, 0, text_ai);
+
+			if (hot->flags & HOT_INVALID_LEN)
+				return hri_error(error, ErrorAI::InvalidSpecLen, ai, text_ai);
+			if (hot->flags & HOT_INVALID_MAX_LEN)
+				return hri_error(error, ErrorAI::InvalidSpecMaxLen, ai, text_ai);
+			int body_min = hot->body_min;
+			int body_max = hot->body_max;
+
+			//fixed-length bodies end where the next AI has to start
+			const char *next = ptr + body_min;
+			if ((body_max > body_min) || (next > end) || ((next < end) && (*next != '(')))
+				next = hri_value_end(ptr, end);
+
+			int body_len = (int)(next - ptr);
+			if (body_len == 0)
+				return hri_error(error, ErrorAI::EmptyBody, ai, text_ai);
+			if (body_len < body_min)
+				return hri_error(error, ErrorAI::BodyTooShort, ai, text_ai);
+			if (body_len > body_max)
+				return hri_error(error, ErrorAI::BodyTooLong, ai, text_ai);
+			if (find_gs1_fnc1(ptr, next) != next)
+				return hri_error(error, ErrorAI::InvalidChar, ai, text_ai);
+
+			f.ai = ai;
+			f.text_ai = text_ai;
+			f.text_body = TextView(ptr, body_len);
+			f.reference_pos = start - hri;
+			f.reference_len = next - start;
+			result.push_back(f);
+
+			GS1_STATS_FIELD(ai);
+			ptr = next;
+		}
+
+		return true;
+	}
+
+	bool parse_hri(std::vector<FieldAI> &result, const char *hri, ErrorAI &error)
+	{
+		result.clear();
+
+		std::vector<FieldView> views;
+		ErrorView ev;
+		bool ok = parse_hri(views, hri, (int)strlen(hri), ev);
+
+		result.resize(views.size());
+		for(int i=0; i<(int)views.size(); i++)
+			views[i].to_field(result[i]);
+		ev.to_error(error);
+		return ok;
+	}
+}
@@ -0,0 +1,42 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_HRI_H__
+#define __GS1_HRI_H__
+
+#include "gs1-parse.h"
+
+namespace GS1
+{
+	//Bracketed human readable form, the input counterpart of format_hri: (01)09506000134352(10)ABC123
+	//A '(' starts the next AI only when followed by a known AI code and ')', otherwise it is part of the value.
+	//Values are delimited, so they are checked against both length limits (BodyTooLong if longer).
+	//Zero-copy: spans point into hri, reference_pos/reference_len cover "(AI)value".
+	bool parse_hri(std::vector<FieldView> &result, const char *hri, int len, ErrorView &error);
+	inline bool parse_hri(std::vector<FieldView> &result, const char *hri, ErrorView &error) { return parse_hri(result, hri, (int)strlen(hri), error); }
+	bool parse_hri(std::vector<FieldAI> &result, const char *hri, ErrorAI &error);
+	inline bool parse_hri(std::vector<FieldAI> &result, const char *hri) { ErrorAI error; return parse_hri(result, hri, error); }
+}
+
+#endif
@@ -0,0 +1,63 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-layout.h"
+
+namespace GS1
+{
+	bool LayoutFieldGS1::resolve(const char *ai_code)
+	{
+		ai = 0;
+		ai_len = 0;
+		body_len = 0;
+		body_len_max = 0;
+
+		int id = find_ai_id(ai_code); //"310n"
+		const AI *spec = (id >= 0) ? get_ai_by_id(id) : get_ai(ai_code);
+		if (!spec)
+			return false;
+
+		int len = strlen(spec->ai);
+		if ((len > (int)sizeof(code)) || ((int)strlen(ai_code) != len))
+			return false;
+
+		int min_len = spec->field_len - len;
+		int max_len = (spec->max_field_len_optional > 0) ? spec->max_field_len_optional - len : min_len;
+		if ((min_len <= 0) || (max_len < min_len) || ((spec->max_field_len_optional > 0) && (max_len == min_len)))
+			return false; //invalid spec, the generic parser reports it
+
+		for(int i=0; i<len; i++)
+		{
+			if ((spec->ai[i] == 'n') && (ai_code[i] != 'n') && ((unsigned char)(ai_code[i] - '0') > 9))
+				return false;
+			code[i] = ai_code[i]; //"3102" - exact, "310n" - any digit
+		}
+
+		ai = spec;
+		ai_len = len;
+		body_len = min_len;
+		body_len_max = max_len;
+		return true;
+	}
+}
@@ -0,0 +1,146 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_LAYOUT_H__
+#define __GS1_LAYOUT_H__
+
+#include "gs1-parse.h"
+#include "gs1-simd.h"
+#include "gs1-stats.h"
+
+namespace GS1
+{
+	//one field of a declared layout, resolved from the spec once
+	class LayoutFieldGS1
+	{
+	public:
+		const AI *ai; //spec
+		char code[4]; //AI code, 'n' - any digit (e.g. "310n")
+		int ai_len;
+		int body_len; //min
+		int body_len_max;
+
+		bool resolve(const char *ai_code); //false: unknown AI or invalid spec
+
+		//fast match of this field at ptr, same result as parse_gs1_field() when true;
+		//false means "not this layout" and the caller falls back to the generic parser
+		inline bool match(FieldView &field, const char *gs1_stream, const char *&ptr, const char *end) const
+		{
+			if (end - ptr < ai_len + body_len)
+				return false;
+
+			for(int i=0; i<ai_len; i++)
+			{
+				if ((ptr[i] != code[i]) && ((code[i] != 'n') || ((unsigned char)(ptr[i] - '0') > 9)))
+					return false;
+			}
+
+			const char *body = ptr + ai_len;
+			const char *next = body + body_len_max;
+			if (next > end)
+				next = end;
+
+			next = find_gs1_fnc1(body, next);
+			if (next - body < body_len)
+				return false; //error, let the generic parser report it
+
+			field.ai = ai;
+			field.text_ai = TextView(ptr, ai_len);
+			field.text_body = TextView(body, next - body);
+
+			while((next < end) && (*next == GS1::FNC1))
+				next++; //skip FNC1
+
+			field.reference_pos = ptr - gs1_stream;
+			field.reference_len = next - ptr;
+
+			ptr = next;
+			return true;
+		}
+	};
+
+	//Parser specialised for a fixed sequence of N AIs, e.g.
+	//	static const char *const pharma_ais[] = { "01", "17", "10", "21" };
+	//	static const GS1::LayoutGS1<4> pharma(pharma_ais);
+	//The spec entries are looked up once in the constructor, a scan is then checked
+	//with a few compares per field. Scans of another layout (or with errors) go to parse_gs1().
+	//Construct layouts after load_spec(), they keep the entries of the spec they were built with.
+	template<int N> class LayoutGS1
+	{
+	public:
+		LayoutGS1(const char *const (&ais)[N])
+		{
+			valid = true;
+			for(int i=0; i<N; i++)
+			{
+				if (!fields[i].resolve(ais[i]))
+					valid = false;
+			}
+		}
+
+		bool IsValid() const { return valid; } //all AIs are known
+
+		//fast path only, allocation-free: false if the scan doesn't have exactly this layout
+		bool ParseLayout(FieldView (&result)[N], const char *gs1_stream, int len) const
+		{
+			GS1_STATS_SCAN(stats);
+
+			const char *ptr = gs1_stream;
+			const char *end = ptr + len;
+			bool ok = valid;
+			for(int i=0; ok && (i<N); i++)
+				ok = fields[i].match(result[i], gs1_stream, ptr, end);
+
+			if (!ok || (ptr != end))
+			{
+				GS1_STATS_CANCEL(stats); //counted by the parse_gs1() fallback
+				return false;
+			}
+
+			for(int i=0; i<N; i++)
+				GS1_STATS_FIELD(result[i].ai);
+			return true;
+		}
+
+		//same results as parse_gs1()
+		bool ParseGS1(std::vector<FieldView> &result, const char *gs1_stream, int len, ErrorView &error) const
+		{
+			FieldView layout[N];
+			if (!ParseLayout(layout, gs1_stream, len))
+				return parse_gs1(result, gs1_stream, len, error);
+
+			error.reset(layout[N-1].reference_pos); //as left by parse_gs1()
+			result.assign(layout, layout + N);
+			return true;
+		}
+		inline bool ParseGS1(std::vector<FieldView> &result, const char *gs1_stream, ErrorView &error) const { return ParseGS1(result, gs1_stream, (int)strlen(gs1_stream), error); }
+		inline bool ParseGS1(std::vector<FieldView> &result, const char *gs1_stream) const { ErrorView error; return ParseGS1(result, gs1_stream, error); }
+
+	protected:
+		LayoutFieldGS1 fields[N];
+		bool valid;
+	};
+}
+
+#endif
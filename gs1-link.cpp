@@ -0,0 +1,284 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-link.h"
+#include "gs1-simd.h"
+#include "gs1-stats.h"
+
+#include <string.h>
+
+namespace GS1
+{
+	//AIs that may start the Digital Link path
+	static const char *const primary_keys[] = {"01", "00", "253", "255", "401", "402", "414", "8003", "8004", "8006", "8010", "8017", "8018"};
+
+	//bit masks: the chars that end a part
+	enum LinkPart
+	{
+		LinkPath = 1,
+		LinkQueryKey = 2,
+		LinkQueryValue = 4,
+		LinkEscape = 8 //'%'
+	};
+
+	//classes of ' ' .. '?', all delimiters are in this range
+	static const unsigned char link_chars[32] =
+	{
+		0, 0, 0, LinkPath|LinkQueryKey|LinkQueryValue, 0, LinkEscape, LinkQueryKey|LinkQueryValue, 0, //  ! " # $ % & '
+		0, 0, 0, 0, 0, 0, 0, LinkPath,			// ( ) * + , - . /
+		0, 0, 0, 0, 0, 0, 0, 0,					// 0 .. 7
+		0, 0, 0, 0, 0, LinkQueryKey, 0, LinkPath	// 8 9 : ; < = > ?
+	};
+
+	static inline int link_class(char c)
+	{
+		unsigned int i = (unsigned char)c - 0x20u;
+		return (i < 32) ? link_chars[i] : 0;
+	}
+
+	static inline int hex_value(char c)
+	{
+		if ((c >= '0') && (c <= '9'))
+			return c - '0';
+		if ((c >= 'A') && (c <= 'F'))
+			return c - 'A' + 10;
+		if ((c >= 'a') && (c <= 'f'))
+			return c - 'a' + 10;
+		return -1;
+	}
+
+	static char* skip_part(char *ptr, const char *end, int part)
+	{
+		while((ptr < end) && !(link_class(*ptr) & part))
+			ptr++;
+		return ptr;
+	}
+
+	//percent-decodes the part at ptr in place, returns the decoded length or -1 (bad escape at stop)
+	static int decode_part(char *ptr, const char *end, int part, char *&stop)
+	{
+		char *in = ptr;
+		while((in < end) && !(link_class(*in) & (part | LinkEscape)))
+			in++;
+
+		//nothing is written until the first escape
+		char *out = in;
+		while((in < end) && !(link_class(*in) & part))
+		{
+			char c = *in;
+			if (c == '%')
+			{
+				int hi = (end - in > 2) ? hex_value(in[1]) : -1;
+				int lo = (hi >= 0) ? hex_value(in[2]) : -1;
+				if (lo < 0)
+				{
+					stop = in;
+					return -1;
+				}
+				c = (char)(hi * 16 + lo);
+				in += 2;
+			}
+			*out++ = c;
+			in++;
+		}
+		stop = in;
+		return (int)(out - ptr);
+	}
+
+	static bool link_error(ErrorView &error, ErrorAI::ErrorCode code, const AI *ai, const TextView &text_ai, int pos)
+	{
+		GS1_STATS_ERROR(code);
+		error.code = code;
+		error.ai = ai;
+		error.text_ai = text_ai;
+		error.reference_pos = pos;
+		return false;
+	}
+
+	static bool is_primary_key(const char *key, int key_len)
+	{
+		for(int i=0; i<(int)(sizeof(primary_keys)/sizeof(primary_keys[0])); i++)
+		{
+			if (((int)strlen(primary_keys[i]) == key_len) && !memcmp(primary_keys[i], key, key_len))
+				return true;
+		}
+		return false;
+	}
+
+	//decodes the value at ptr and fills field, ptr is moved to the stop char
+	static bool link_field(FieldView &field, const AI *ai, const HotAI *hot, const char *uri, const char *key, int key_len, char *&ptr, const char *end, int part, ErrorView &error)
+	{
+		TextView text_ai(key, key_len);
+		int pos = (int)(key - uri);
+
+		if (hot->flags & HOT_INVALID_LEN)
+			return link_error(error, ErrorAI::InvalidSpecLen, ai, text_ai, pos);
+		if (hot->flags & HOT_INVALID_MAX_LEN)
+			return link_error(error, ErrorAI::InvalidSpecMaxLen, ai, text_ai, pos);
+		int body_min = hot->body_min;
+		int body_max = hot->body_max;
+
+		char *body = ptr;
+		char *stop;
+		int body_len = decode_part(body, end, part, stop);
+		if (body_len < 0)
+			return link_error(error, ErrorAI::InvalidChar, ai, text_ai, (int)(stop - uri));
+		if (body_len == 0)
+			return link_error(error, ErrorAI::EmptyBody, ai, text_ai, pos);
+		if (body_len < body_min)
+			return link_error(error, ErrorAI::BodyTooShort, ai, text_ai, pos);
+		if (body_len > body_max)
+			return link_error(error, ErrorAI::BodyTooLong, ai, text_ai, pos);
+		if ((find_gs1_fnc1(body, body + body_len) != body + body_len) || memchr(body, 0, body_len))
+			return link_error(error, ErrorAI::InvalidChar, ai, text_ai, pos); //decoded %1D or %00
+
+		field.ai = ai;
+		field.text_ai = text_ai;
+		field.text_body = TextView(body, body_len);
+		field.reference_pos = pos;
+		field.reference_len = (int)(stop - key);
+
+		GS1_STATS_FIELD(ai);
+		ptr = stop;
+		return true;
+	}
+
+	bool is_digital_link(const char *scan, int len)
+	{
+		static const char http[] = "http";
+		if (len < 7)
+			return false;
+		for(int i=0; i<4; i++)
+		{
+			if ((scan[i] | 0x20) != http[i])
+				return false;
+		}
+		const char *rest = scan + 4;
+		if ((rest[0] | 0x20) == 's')
+			rest++;
+		return (scan + len - rest >= 3) && !memcmp(rest, "://", 3);
+	}
+
+	bool parse_digital_link(std::vector<FieldView> &result, char *uri, int len, ErrorView &error)
+	{
+		GS1_STATS_SCAN(stats);
+		result.clear();
+		error.reset(0);
+
+		char *ptr = uri;
+		const char *end = uri + len;
+
+		//scheme and host
+		char *host = (char*)memchr(uri, ':', len);
+		if (host && (end - host >= 3) && (host[1] == '/') && (host[2] == '/'))
+			ptr = host + 3;
+		while((ptr < end) && (*ptr != '/') && (*ptr != '?') && (*ptr != '#'))
+			ptr++;
+
+		//path: optional prefix segments, then AI/value pairs from the first primary key
+		FieldView f;
+		bool keys = false;
+		while((ptr < end) && (*ptr == '/'))
+		{
+			const char *key = ++ptr;
+			ptr = skip_part(ptr, end, LinkPath);
+			int key_len = (int)(ptr - key);
+
+			if (!keys)
+			{
+				if (!is_primary_key(key, key_len))
+					continue; //prefix
+				keys = true;
+			}
+			else if ((key_len == 0) && ((ptr == end) || (*ptr != '/')))
+				break; //trailing slash
+
+			const HotAI *hot;
+			const AI *ai = get_ai_exact(key, key_len, hot);
+			if (!ai)
+				return link_error(error, ErrorAI::UnknownAI, 0, TextView(key, key_len), (int)(key - uri));
+			if ((ptr == end) || (*ptr != '/'))
+				return link_error(error, ErrorAI::EmptyBody, ai, TextView(key, key_len), (int)(key - uri));
+
+			ptr++;
+			if (!link_field(f, ai, hot, uri, key, key_len, ptr, end, LinkPath, error))
+				return false;
+			result.push_back(f);
+		}
+
+		if (!keys)
+			return link_error(error, ErrorAI::UnknownAI, 0, TextView(), (int)(ptr - uri)); //no primary key in the path
+
+		//query: AI=value pairs, other parameters (linkType, ...) are skipped
+		if ((ptr < end) && (*ptr == '?'))
+		{
+			ptr++;
+			while((ptr < end) && (*ptr != '#'))
+			{
+				const char *key = ptr;
+				ptr = skip_part(ptr, end, LinkQueryKey);
+				int key_len = (int)(ptr - key);
+
+				const HotAI *hot = 0;
+				const AI *ai = get_ai_exact(key, key_len, hot);
+				if (!ai)
+				{
+					if ((key_len > 0) && isstrdigit(key, key_len))
+						return link_error(error, ErrorAI::UnknownAI, 0, TextView(key, key_len), (int)(key - uri));
+					ptr = skip_part(ptr, end, LinkQueryValue);
+				}
+				else if ((ptr == end) || (*ptr != '='))
+					return link_error(error, ErrorAI::EmptyBody, ai, TextView(key, key_len), (int)(key - uri)); //AI without a value
+				else
+				{
+					ptr++;
+					if (!link_field(f, ai, hot, uri, key, key_len, ptr, end, LinkQueryValue, error))
+						return false;
+					result.push_back(f);
+				}
+
+				if ((ptr < end) && (*ptr == '&'))
+					ptr++;
+			}
+		}
+
+		return true;
+	}
+
+	bool parse_digital_link(std::vector<FieldAI> &result, const char *uri, ErrorAI &error)
+	{
+		std::string buf(uri);
+		std::vector<FieldView> views;
+		ErrorView ev;
+
+		result.clear();
+		bool ok = parse_digital_link(views, buf.empty() ? 0 : &buf[0], (int)buf.length(), ev);
+
+		result.resize(views.size());
+		for(int i=0; i<(int)views.size(); i++)
+			views[i].to_field(result[i]);
+		ev.to_error(error);
+		return ok;
+	}
+}
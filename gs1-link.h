@@ -0,0 +1,53 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_LINK_H__
+#define __GS1_LINK_H__
+
+#include "gs1-parse.h"
+
+namespace GS1
+{
+	//GS1 Digital Link URI: scheme://host[/prefix...]/primary-key-AI/value[/AI/value...][?AI=value&...][#fragment]
+	//Path and query AIs are numeric codes (e.g. "01", "3103"), the path starts at the first primary key (01, 00, 414, ...).
+	//Values are checked like element string bodies (a GTIN must have 14 digits), other query parameters are skipped.
+	bool is_digital_link(const char *scan, int len); //"http://" or "https://", any case
+
+	//Single pass over uri, values are percent-decoded in place: text_body spans point into the decoded uri.
+	//reference_pos/reference_len cover "AI/value" or "AI=value" in uri, error.reference_pos is the offset of the bad part.
+	bool parse_digital_link(std::vector<FieldView> &result, char *uri, int len, ErrorView &error);
+	inline bool parse_digital_link(std::vector<FieldView> &result, char *uri, ErrorView &error) { return parse_digital_link(result, uri, (int)strlen(uri), error); }
+	bool parse_digital_link(std::vector<FieldAI> &result, const char *uri, ErrorAI &error); //uri is not modified
+	inline bool parse_digital_link(std::vector<FieldAI> &result, const char *uri) { ErrorAI error; return parse_digital_link(result, uri, error); }
+
+	//mixed scanner traffic: Digital Link URI or element string
+	inline bool parse_gs1_any(std::vector<FieldView> &result, char *scan, int len, ErrorView &error)
+	{
+		if (is_digital_link(scan, len))
+			return parse_digital_link(result, scan, len, error);
+		return parse_gs1(result, scan, len, error);
+	}
+}
+
+#endif
@@ -1,253 +1,463 @@
-/*
-MIT License
-
-Copyright (c) 2021 Serge Reinov
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in all
-copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-SOFTWARE.
-*/
-
-#include "gs1-parse.h"
-
-#ifdef WIN32
-#pragma warning(disable:4996) //about unsafe sprintf
-#endif
-
-namespace GS1
-{
-	
-	bool isstrdigit(const char *ptr, int digits_count)
-	{
-		while(digits_count > 0)
-		{
-			if (!*ptr || !isdigit(*ptr))
-				return false;
-			ptr++;
-			digits_count--;
-		}
-		return true;
-	}
-
-	bool FieldAI::format_body(std::string &result, bool ISO_date) const
-	{
-		if (!ai || text_body.empty())
-			return false;
-
-		switch(ai->data_format)
-		{
-		default:
-		case GS1_STRING:
-			result = text_body;
-			break;
-		case GS1_DATE:
-			{
-				//YYMMDD
-				if (!isstrdigit(text_body.c_str(), 6))
-					return false; //error format
-			
-				int yy = 2000 + atoi(text_body.substr(0, 2).c_str());
-				int mm = atoi(text_body.substr(2, 2).c_str());
-				int dd = atoi(text_body.substr(4, 2).c_str());
-				if ((mm < 1) || (mm > 12) ||
-					(dd < 1) || (dd > 31))
-					return false; //err fmt
-
-				char buf[32];
-				if (ISO_date)
-					sprintf(buf, "%4.4u-%2.2u-%2.2u", yy, mm, dd); //YYYY-MM-DD
-				else
-					sprintf(buf, "%2.2u-%2.2u-%4.4u", dd, mm, yy); //DD-MM-YYYY
-
-				result = buf;
-			}
-			break;
-		case GS1_DECIMAL:
-			{
-				if (!isstrdigit(text_body.c_str(), text_body.length()))
-					return false; //error format
-
-				int ai_len = strlen(ai->ai);
-				if (ai->ai[ai_len-1] != 'n')
-					return false;
-
-				int decimal_point = (int)(*text_ai.rbegin() - '0');
-				int body_len = text_body.length();
-				int pos = body_len - decimal_point;
-				if (pos <= 0)
-				{
-					result = "0.";
-					while(pos++ < 0)
-						result.push_back('0');
-					result += text_body;
-					break; //ok
-				}
-
-				result = text_body;
-				if (decimal_point > 0)
-					result.insert(pos, ".");
-
-				while((result[0] == '0') && (result[1] != '.'))
-					result.erase(0, 1);
-			}
-			break;
-		}
-
-		return true;
-	}
-
-	bool FieldsGS1::ParseGS1(const char *gs1_stream)
-	{
-		//clear
-		ai_map.clear();
-		fields.clear();
-
-		bool ok = parse_gs1(fields, gs1_stream);
-		if (ok)
-		{
-			for(int i=0; i<(int)fields.size(); i++)
-				ai_map[fields[i].ai->ai] = i;
-		}
-		return ok;
-	}
-
-	int FieldsGS1::GetCount()
-	{
-		return (int)fields.size();
-	}
-
-	const FieldAI* FieldsGS1::Get(int index)
-	{
-		if (index < (int)fields.size())
-			return &fields[index];
-		return 0;
-	}
-
-	const FieldAI* FieldsGS1::GetByAI(const std::string &ai)
-	{
-		std::map<std::string, int>::const_iterator it = ai_map.find(ai);
-		if (it != ai_map.end())
-			return &fields[it->second];
-		return 0;
-	}
-
-
-	const char * copy_gs1_body(std::string &body, int min_len, const char *ptr, const char *end)
-	{
-		body.clear();
-
-		int len = end - ptr;
-		if (len < min_len)
-			return 0;
-
-		body.reserve(len+1);
-
-		while(*ptr && (ptr < end) && (*ptr != GS1::FNC1))
-		{
-			body.push_back(*ptr);
-			ptr++;
-		}
-
-		while(*ptr && (ptr < end) && (*ptr == GS1::FNC1))
-			ptr++; //skip FNC1
-
-		if ((int)body.length() < min_len)
-			return 0;
-
-		return ptr;
-	}
-
-	bool parse_gs1(std::vector<FieldAI> &result, const char *gs1_stream, ErrorAI &error)
-	{
-		result.clear();
-
-		const char *ptr = gs1_stream;
-		int len = strlen(gs1_stream);
-		const char *end = ptr + len;
-
-		while(ptr < end)
-		{
-			error.reset(ptr - gs1_stream);	
-
-			const AI* ai = get_ai(ptr);
-			if (!ai)
-			{
-				error.code = ErrorAI::UnknownAI;
-				break; //unknown ai
-			}
-
-			const char *start = ptr;
-
-			FieldAI f;
-			f.ai = ai;
-			f.reference_pos = start - gs1_stream;
-
-			int ai_len = strlen(f.ai->ai);
-			f.text_ai = std::string(ptr, ai_len);
-			ptr += ai_len;
-
-			error.ai = f.ai;
-			error.text_ai = f.text_ai;
-
-			int body_len = f.ai->field_len - ai_len;
-			if (body_len <= 0)
-			{
-				error.code = ErrorAI::InvalidSpecLen;
-				return false; //invalid format
-			}
-
-			const char *next;
-			if (f.ai->max_field_len_optional > 0)
-			{
-				//vari len
-				int body_len_max = f.ai->max_field_len_optional - ai_len;
-				if (body_len_max <= body_len)
-				{
-					error.code = ErrorAI::InvalidSpecMaxLen;
-					return false; //invalid format
-				}
-
-				next = ptr + body_len_max;
-			}
-			else
-			{
-				//const len
-				next = ptr + body_len;
-			}
-
-			if (next > end)
-				next = end;
-
-			next = copy_gs1_body(f.text_body, body_len, ptr, next);
-			if (!next)
-			{
-				error.code = f.text_body.empty() ? ErrorAI::EmptyBody : ErrorAI::BodyTooShort;
-				return false; //can't get body (wrong min_len-param or body too short)
-			}
-
-			while(*next && (next < end) && (*next == GS1::FNC1))
-				next++; //skip FNC1
-
-			ptr = next;
-			f.reference_len = ptr - start;
-
-			result.push_back(f);
-		}
-
-		return (ptr == end);
-	}
-}
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-parse.h"
+#include "gs1-simd.h"
+#include "gs1-stats.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WIN32
+#pragma warning(disable:4996) //about unsafe sprintf
+#endif
+
+namespace GS1
+{
+	
+	bool FieldAI::format_body(std::string &result, bool ISO_date) const
+	{
+		if (!ai || text_body.empty())
+			return false;
+
+		switch(ai->data_format)
+		{
+		default:
+		case GS1_STRING:
+			result = text_body;
+			break;
+		case GS1_DATE:
+			{
+				DateGS1 date;
+				if (!decode_date(text_body.c_str(), (int)text_body.length(), date))
+					return false; //error format
+
+				char buf[32];
+				if (ISO_date)
+					sprintf(buf, "%4.4u-%2.2u-%2.2u", date.year, date.month, date.day); //YYYY-MM-DD
+				else
+					sprintf(buf, "%2.2u-%2.2u-%4.4u", date.day, date.month, date.year); //DD-MM-YYYY
+
+				result = buf;
+			}
+			break;
+		case GS1_DECIMAL:
+			{
+				if (!isstrdigit(text_body.c_str(), (int)text_body.length()))
+					return false; //error format
+
+				int ai_len = strlen(ai->ai);
+				if (ai->ai[ai_len-1] != 'n')
+					return false;
+
+				int decimal_point = (int)(*text_ai.rbegin() - '0');
+				int body_len = text_body.length();
+				int pos = body_len - decimal_point;
+				if (pos <= 0)
+				{
+					result = "0.";
+					while(pos++ < 0)
+						result.push_back('0');
+					result += text_body;
+					break; //ok
+				}
+
+				result = text_body;
+				if (decimal_point > 0)
+					result.insert(pos, ".");
+
+				while((result[0] == '0') && (result[1] != '.'))
+					result.erase(0, 1);
+			}
+			break;
+		}
+
+		return true;
+	}
+
+	int DateGS1::epoch_day() const
+	{
+		//days from civil, proleptic Gregorian calendar
+		int y = year - (month <= 2);
+		int era = (y >= 0 ? y : y - 399) / 400;
+		int yoe = y - era * 400;
+		int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+		int doe = yoe * 365 + yoe/4 - yoe/100 + doy;
+		return era * 146097 + doe - 719468;
+	}
+
+	double DecimalGS1::to_double() const
+	{
+		//powers of 10 are exact in double up to 1e22
+		static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+		if (exponent >= 0)
+			return (double)mantissa * pow10[exponent];
+		return (double)mantissa / pow10[-exponent];
+	}
+
+	static inline int two_digits(const char *ptr)
+	{
+		return (ptr[0] - '0') * 10 + (ptr[1] - '0');
+	}
+
+	bool decode_date(const char *body, int body_len, DateGS1 &result)
+	{
+		//YYMMDD
+		if ((body_len != 6) || !isstrdigit(body, 6))
+			return false;
+
+		int mm = two_digits(body + 2);
+		int dd = two_digits(body + 4);
+		if ((mm < 1) || (mm > 12) ||
+			(dd < 1) || (dd > 31))
+			return false;
+
+		result.year = 2000 + two_digits(body);
+		result.month = mm;
+		result.day = dd;
+		return true;
+	}
+
+	//fixed numeric components between AI and amount, e.g. "N4+N3+N..15" - ISO currency N3
+	static int decimal_prefix_len(const AI *ai)
+	{
+		const char *p = ai->desc_format ? strchr(ai->desc_format, '+') : 0;
+		if (!p)
+			return 0;
+
+		int len = 0;
+		for(;;)
+		{
+			const char *next = strchr(p + 1, '+');
+			if (!next)
+				return len; //p is the amount
+
+			if ((p[1] != 'N') || !isstrdigit(p + 2, (int)(next - p - 2)))
+				return -1; //not a fixed numeric component
+			len += atoi(p + 2);
+			p = next;
+		}
+	}
+
+	bool decode_decimal(const AI *ai, const char *text_ai, int ai_len, const char *body, int body_len, DecimalGS1 &result)
+	{
+		if (!ai || (ai->data_format != GS1_DECIMAL) || (ai_len < 1))
+			return false;
+
+		int spec_len = strlen(ai->ai);
+		if ((ai->ai[spec_len-1] != 'n') || (ai_len != spec_len))
+			return false;
+
+		int decimal_point = text_ai[ai_len-1] - '0';
+		if ((decimal_point < 0) || (decimal_point > 9))
+			return false;
+
+		int prefix = decimal_prefix_len(ai);
+		int digits = body_len - prefix;
+		if ((prefix < 0) || (digits < 1) || (digits > 18) || !isstrdigit(body, body_len))
+			return false;
+
+		long long mantissa = 0;
+		for(const char *p = body + prefix; p < body + body_len; p++)
+			mantissa = mantissa * 10 + (*p - '0');
+
+		int currency = -1;
+		if (prefix >= 3)
+			currency = (body[0] - '0') * 100 + two_digits(body + 1);
+
+		result.mantissa = mantissa;
+		result.exponent = -decimal_point;
+		result.currency = currency;
+		return true;
+	}
+
+	bool FieldAI::get_date(DateGS1 &result) const
+	{
+		if (!ai || (ai->data_format != GS1_DATE))
+			return false;
+		return decode_date(text_body.data(), (int)text_body.length(), result);
+	}
+
+	bool FieldAI::get_decimal(DecimalGS1 &result) const
+	{
+		return decode_decimal(ai, text_ai.data(), (int)text_ai.length(), text_body.data(), (int)text_body.length(), result);
+	}
+
+	bool FieldAI::get_double(double &result) const
+	{
+		DecimalGS1 d;
+		if (!get_decimal(d))
+			return false;
+		result = d.to_double();
+		return true;
+	}
+
+	bool FieldView::get_date(DateGS1 &result) const
+	{
+		if (!ai || (ai->data_format != GS1_DATE))
+			return false;
+		return decode_date(text_body.ptr, text_body.len, result);
+	}
+
+	bool FieldView::get_decimal(DecimalGS1 &result) const
+	{
+		return decode_decimal(ai, text_ai.ptr, text_ai.len, text_body.ptr, text_body.len, result);
+	}
+
+	bool FieldView::get_double(double &result) const
+	{
+		DecimalGS1 d;
+		if (!get_decimal(d))
+			return false;
+		result = d.to_double();
+		return true;
+	}
+
+	bool FieldsGS1::ParseGS1(const char *gs1_stream)
+	{
+		//clear only the entries of the previous scan
+		if ((int)ai_index.size() != get_ai_count())
+			ai_index.assign(get_ai_count(), 0);
+		else
+		{
+			for(int i=0; i<(int)fields.size(); i++)
+			{
+				int id = get_ai_id(fields[i].ai);
+				if (id < 0)
+				{
+					ai_index.assign(get_ai_count(), 0); //parsed with a replaced spec
+					break;
+				}
+				ai_index[id] = 0;
+			}
+		}
+		fields.clear();
+
+		bool ok = parse_gs1(fields, gs1_stream);
+		if (ok)
+		{
+			for(int i=0; i<(int)fields.size(); i++)
+			{
+				int id = get_ai_id(fields[i].ai);
+				if (id >= 0)
+					ai_index[id] = (unsigned short)(i + 1);
+			}
+		}
+		return ok;
+	}
+
+	int FieldsGS1::GetCount() const
+	{
+		return (int)fields.size();
+	}
+
+	const FieldAI* FieldsGS1::Get(int index) const
+	{
+		if (index < (int)fields.size())
+			return &fields[index];
+		return 0;
+	}
+
+	const FieldAI* FieldsGS1::GetByAI(const char *ai) const
+	{
+		return GetByAI(find_ai_id(ai));
+	}
+
+	const FieldAI* FieldsGS1::GetByAI(int ai_id) const
+	{
+		if ((ai_id < 0) || (ai_id >= (int)ai_index.size()) || !ai_index[ai_id])
+			return 0;
+		return &fields[ai_index[ai_id] - 1];
+	}
+
+
+	void FieldView::to_field(FieldAI &result) const
+	{
+		result.ai = ai;
+		text_ai.copy_to(result.text_ai);
+		text_body.copy_to(result.text_body);
+		result.reference_pos = reference_pos;
+		result.reference_len = reference_len;
+	}
+
+	void ErrorView::to_error(ErrorAI &result) const
+	{
+		result.code = code;
+		result.ai = ai;
+		text_ai.copy_to(result.text_ai);
+		result.reference_pos = reference_pos;
+	}
+
+	static bool field_error(ErrorView &error, ErrorAI::ErrorCode code, const AI *ai, const TextView &text_ai)
+	{
+		GS1_STATS_ERROR(code);
+		error.code = code;
+		error.ai = ai;
+		error.text_ai = text_ai;
+		return false;
+	}
+
+	bool parse_gs1_field(FieldView &field, const char *gs1_stream, const char *&ptr, const char *end, ErrorView &error)
+	{
+		error.reset(ptr - gs1_stream);
+
+		//only the packed HotAI is read here, the AI record is not touched
+		const HotAI *hot;
+		const AI* ai = get_ai(ptr, end - ptr, hot);
+		if (!ai)
+			return field_error(error, ErrorAI::UnknownAI, 0, TextView());
+
+		const char *start = ptr;
+
+		int ai_len = hot->ai_len;
+		int avail = end - start;
+		TextView text_ai(start, (ai_len < avail) ? ai_len : avail);
+
+		if (hot->flags & (HOT_INVALID_LEN | HOT_INVALID_MAX_LEN))
+			return field_error(error, (hot->flags & HOT_INVALID_LEN) ? ErrorAI::InvalidSpecLen : ErrorAI::InvalidSpecMaxLen, ai, text_ai); //invalid format
+
+		int body_len = hot->body_min;
+		int body_len_max = hot->body_max;
+
+		const char *body = start + text_ai.len;
+		const char *next = body + body_len_max;
+		if (next > end)
+			next = end;
+
+		if (next - body < body_len)
+			return field_error(error, ErrorAI::EmptyBody, ai, text_ai); //not enough data for min_len
+
+		next = find_gs1_fnc1(body, next);
+		if (next - body < body_len)
+			return field_error(error, (next == body) ? ErrorAI::EmptyBody : ErrorAI::BodyTooShort, ai, text_ai);
+
+		field.ai = ai;
+		field.text_ai = text_ai;
+		field.text_body = TextView(body, next - body);
+
+		while((next < end) && (*next == GS1::FNC1))
+			next++; //skip FNC1
+
+		field.reference_pos = start - gs1_stream;
+		field.reference_len = next - start;
+
+		GS1_STATS_FIELD(ai);
+		ptr = next;
+		return true;
+	}
+
+	bool parse_gs1(std::vector<FieldView> &result, const char *gs1_stream, int len, ErrorView &error)
+	{
+		GS1_STATS_SCAN(stats);
+		result.clear();
+
+		const char *ptr = gs1_stream;
+		const char *end = ptr + len;
+
+		FieldView f;
+		while(ptr < end)
+		{
+			if (!parse_gs1_field(f, gs1_stream, ptr, end, error))
+				return false;
+
+			result.push_back(f);
+		}
+
+		return true;
+	}
+
+	bool parse_gs1(std::vector<FieldAI> &result, const char *gs1_stream, ErrorAI &error)
+	{
+		GS1_STATS_SCAN(stats);
+		result.clear();
+
+		const char *ptr = gs1_stream;
+		const char *end = ptr + strlen(gs1_stream);
+
+		ErrorView ev;
+		FieldView f;
+		bool ok = true;
+		while(ptr < end)
+		{
+			if (!parse_gs1_field(f, gs1_stream, ptr, end, ev))
+			{
+				ok = false;
+				break;
+			}
+
+			result.push_back(FieldAI());
+			f.to_field(result.back());
+		}
+
+		ev.to_error(error); //copy error strings once, not per field
+
+		return ok;
+	}
+
+	bool parse_gs1_recover(std::vector<FieldView> &result, const char *gs1_stream, int len, std::vector<ErrorView> &errors)
+	{
+		GS1_STATS_SCAN(stats);
+		result.clear();
+		errors.clear();
+
+		const char *ptr = gs1_stream;
+		const char *end = ptr + len;
+
+		FieldView f;
+		ErrorView error;
+		while(ptr < end)
+		{
+			if (parse_gs1_field(f, gs1_stream, ptr, end, error))
+			{
+				result.push_back(f);
+				continue;
+			}
+
+			errors.push_back(error);
+
+			//resynchronise: the next field can only start after a FNC1
+			ptr = find_gs1_fnc1(ptr, end);
+			while((ptr < end) && (*ptr == GS1::FNC1))
+				ptr++;
+		}
+
+		return errors.empty();
+	}
+
+	bool parse_gs1_recover(std::vector<FieldAI> &result, const char *gs1_stream, std::vector<ErrorAI> &errors)
+	{
+		std::vector<FieldView> views;
+		std::vector<ErrorView> error_views;
+		bool ok = parse_gs1_recover(views, gs1_stream, (int)strlen(gs1_stream), error_views);
+
+		result.resize(views.size());
+		for(int i=0; i<(int)views.size(); i++)
+			views[i].to_field(result[i]);
+		errors.resize(error_views.size());
+		for(int i=0; i<(int)error_views.size(); i++)
+			error_views[i].to_error(errors[i]);
+		return ok;
+	}
+}
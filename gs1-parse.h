@@ -1,94 +1,197 @@
-/*
-MIT License
-
-Copyright (c) 2021 Serge Reinov
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in all
-copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-SOFTWARE.
-*/
-
-#ifndef __GS1_PARSE_H__
-#define __GS1_PARSE_H__
-
-#include "gs1-spec.h"
-
-#include <string>
-#include <vector>
-#include <map>
-
-namespace GS1
-{
-	class FieldAI
-	{
-	public:
-
-		const AI *ai; //spec
-
-		std::string text_ai;
-		std::string text_body;
-
-		int reference_pos;
-		int reference_len;
-
-		bool format_body(std::string &result, bool ISO_date) const;
-		inline std::string format_body(bool ISO_date) const { std::string r; format_body(r, ISO_date); return r; }
-		inline std::string format_body() const { return format_body(false); }
-	};
-	
-	class ErrorAI
-	{
-	public:
-		enum ErrorCode
-		{
-			Ok = 0,
-			UnknownAI = 1,
-			InvalidSpecLen = 2, //invalid gs1-spec (field_len - ai_len <= 0)
-			InvalidSpecMaxLen = 3, //invalid gs1-spec (max_len > 0 && max_len <= field_len)
-			EmptyBody = 4,
-			BodyTooShort = 5
-		};
-
-		ErrorCode code;
-
-		const AI *ai; //spec
-		std::string text_ai;
-		int reference_pos;
-
-		ErrorAI() { reset(0); }
-		void reset(int pos) { code = Ok; ai=0; text_ai.clear(); reference_pos=pos; }
-	};
-
-	class FieldsGS1
-	{
-	public:
-		bool ParseGS1(const char *gs1_stream);
-
-		int GetCount();
-		const FieldAI* Get(int index);
-		const FieldAI* GetByAI(const std::string &ai);
-
-	protected:
-		std::vector<FieldAI> fields;
-		std::map<std::string, int> ai_map; //index by AI::ai
-	};
-
-	bool parse_gs1(std::vector<FieldAI> &result, const char *gs1_stream, ErrorAI &error);
-	inline bool parse_gs1(std::vector<FieldAI> &result, const char *gs1_stream) { ErrorAI error; return parse_gs1(result, gs1_stream, error); }
-}
-
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_PARSE_H__
+#define __GS1_PARSE_H__
+
+#include "gs1-spec.h"
+
+#include <string>
+#include <vector>
+#include <string.h>
+
+namespace GS1
+{
+	//GS1_DATE value (YYMMDD, century 20YY)
+	class DateGS1
+	{
+	public:
+		int year;
+		int month;
+		int day;
+
+		int packed() const { return year*10000 + month*100 + day; } //YYYYMMDD
+		int epoch_day() const; //days since 1970-01-01
+	};
+
+	//GS1_DECIMAL value as fixed point: mantissa * 10^exponent, exponent is minus the AI's last digit
+	class DecimalGS1
+	{
+	public:
+		long long mantissa;
+		int exponent;
+		int currency; //ISO 4217 numeric code (391n, 393n), -1 if not present
+
+		double to_double() const;
+	};
+
+	//allocation-free decoders of body text
+	bool decode_date(const char *body, int body_len, DateGS1 &result);
+	bool decode_decimal(const AI *ai, const char *text_ai, int ai_len, const char *body, int body_len, DecimalGS1 &result);
+
+	class FieldAI
+	{
+	public:
+
+		const AI *ai; //spec
+
+		std::string text_ai;
+		std::string text_body;
+
+		int reference_pos;
+		int reference_len;
+
+		bool format_body(std::string &result, bool ISO_date) const;
+		inline std::string format_body(bool ISO_date) const { std::string r; format_body(r, ISO_date); return r; }
+		inline std::string format_body() const { return format_body(false); }
+
+		//typed values, false if the AI has another data format or the body is invalid
+		bool get_date(DateGS1 &result) const;
+		bool get_decimal(DecimalGS1 &result) const;
+		bool get_double(double &result) const;
+	};
+	
+	class ErrorAI
+	{
+	public:
+		enum ErrorCode
+		{
+			Ok = 0,
+			UnknownAI = 1,
+			InvalidSpecLen = 2, //invalid gs1-spec (field_len - ai_len <= 0)
+			InvalidSpecMaxLen = 3, //invalid gs1-spec (max_len > 0 && max_len <= field_len)
+			EmptyBody = 4,
+			BodyTooShort = 5,
+			BodyTooLong = 6, //encoding, delimited input (HRI, Digital Link): value longer than the spec allows
+			BufferTooSmall = 7, //encoding: output buffer is full
+			InvalidChar = 8, //encoding: FNC1 or NUL inside a value; validation: char not allowed by desc_format
+			InvalidCheckDigit = 9, //validation
+			MissingAI = 10, //association rules: an AI this field requires is not in the scan
+			ExcludedAI = 11 //association rules: the scan has an AI that must not appear with this field
+		};
+
+		ErrorCode code;
+
+		const AI *ai; //spec
+		std::string text_ai;
+		int reference_pos;
+
+		ErrorAI() { reset(0); }
+		void reset(int pos) { code = Ok; ai=0; text_ai.clear(); reference_pos=pos; }
+	};
+
+	//non-owning span of the caller's gs1_stream
+	class TextView
+	{
+	public:
+		const char *ptr;
+		int len;
+
+		TextView() : ptr(0), len(0) {}
+		TextView(const char *p, int l) : ptr(p), len(l) {}
+
+		bool empty() const { return len <= 0; }
+		void copy_to(std::string &result) const { result.assign(ptr, len); }
+		inline std::string str() const { return std::string(ptr, len); }
+	};
+
+	//zero-copy field, valid while the parsed gs1_stream is alive
+	class FieldView
+	{
+	public:
+
+		const AI *ai; //spec
+
+		TextView text_ai;
+		TextView text_body;
+
+		int reference_pos;
+		int reference_len;
+
+		void to_field(FieldAI &result) const;
+
+		bool get_date(DateGS1 &result) const;
+		bool get_decimal(DecimalGS1 &result) const;
+		bool get_double(double &result) const;
+	};
+
+	//allocation-free counterpart of ErrorAI
+	class ErrorView
+	{
+	public:
+		ErrorAI::ErrorCode code;
+
+		const AI *ai; //spec
+		TextView text_ai;
+		int reference_pos;
+
+		ErrorView() { reset(0); }
+		void reset(int pos) { code = ErrorAI::Ok; ai=0; text_ai = TextView(); reference_pos=pos; }
+		void to_error(ErrorAI &result) const;
+	};
+
+	class FieldsGS1
+	{
+	public:
+		bool ParseGS1(const char *gs1_stream);
+
+		int GetCount() const;
+		const FieldAI* Get(int index) const;
+		const FieldAI* GetByAI(const std::string &ai) const { return GetByAI(ai.c_str()); }
+		const FieldAI* GetByAI(const char *ai) const; //AI::ai, e.g. "01" or "310n"
+		const FieldAI* GetByAI(int ai_id) const; //get_ai_id()
+
+	protected:
+		std::vector<FieldAI> fields;
+		std::vector<unsigned short> ai_index; //by AI id: field index + 1, 0 - not present
+	};
+
+	bool parse_gs1(std::vector<FieldAI> &result, const char *gs1_stream, ErrorAI &error);
+	inline bool parse_gs1(std::vector<FieldAI> &result, const char *gs1_stream) { ErrorAI error; return parse_gs1(result, gs1_stream, error); }
+
+	//zero-copy parsing: result spans point into gs1_stream, nothing is allocated except result growth
+	bool parse_gs1(std::vector<FieldView> &result, const char *gs1_stream, int len, ErrorView &error);
+	inline bool parse_gs1(std::vector<FieldView> &result, const char *gs1_stream, ErrorView &error) { return parse_gs1(result, gs1_stream, (int)strlen(gs1_stream), error); }
+	inline bool parse_gs1(std::vector<FieldView> &result, const char *gs1_stream) { ErrorView error; return parse_gs1(result, gs1_stream, error); }
+
+	//recovery mode: a failed field is recorded in errors and parsing resumes after the next FNC1,
+	//result gets every field that could be parsed; true if there were no errors
+	bool parse_gs1_recover(std::vector<FieldView> &result, const char *gs1_stream, int len, std::vector<ErrorView> &errors);
+	bool parse_gs1_recover(std::vector<FieldAI> &result, const char *gs1_stream, std::vector<ErrorAI> &errors);
+
+	//parse single field at ptr, on success moves ptr to the next field (FNC1 skipped)
+	bool parse_gs1_field(FieldView &field, const char *gs1_stream, const char *&ptr, const char *end, ErrorView &error);
+}
+
 #endif
\ No newline at end of file
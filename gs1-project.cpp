@@ -0,0 +1,114 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-project.h"
+#include "gs1-simd.h"
+#include "gs1-stats.h"
+
+namespace GS1
+{
+	ProjectionGS1::ProjectionGS1(const char *const *ais, int ai_count)
+		: count(0)
+	{
+		for(int i=0; i<ai_count; i++)
+			Add(ais[i]);
+	}
+
+	int ProjectionGS1::Add(const char *ai)
+	{
+		int id = find_ai_id(ai);
+		if (id < 0)
+			return -1;
+
+		if ((int)slot_by_id.size() != get_ai_count())
+			slot_by_id.resize(get_ai_count(), -1);
+		if (slot_by_id[id] < 0)
+			slot_by_id[id] = (short)count++;
+		return slot_by_id[id];
+	}
+
+	void ProjectionGS1::Clear()
+	{
+		slot_by_id.clear();
+		count = 0;
+	}
+
+	int ProjectionGS1::Parse(FieldView *fields, const char *gs1_stream, int len, ErrorView &error) const
+	{
+		GS1_STATS_SCAN(stats);
+		error.reset(0);
+
+		for(int i=0; i<count; i++)
+		{
+			fields[i].ai = 0;
+			fields[i].text_ai = TextView();
+			fields[i].text_body = TextView();
+			fields[i].reference_pos = 0;
+			fields[i].reference_len = 0;
+		}
+
+		const char *ptr = gs1_stream;
+		const char *end = ptr + len;
+		const int slots = (int)slot_by_id.size();
+
+		int found = 0;
+		while((ptr < end) && (found < count))
+		{
+			const HotAI *hot;
+			const AI *ai = get_ai(ptr, end - ptr, hot);
+			int slot = (ai && (hot->id < slots)) ? slot_by_id[hot->id] : -1;
+			if ((slot >= 0) && !fields[slot].ai)
+			{
+				if (!parse_gs1_field(fields[slot], gs1_stream, ptr, end, error))
+					return -1;
+				found++;
+				continue;
+			}
+
+			//skip the field; on errors the generic parser fails the same way and sets error
+			FieldView skipped;
+			if (!ai || (hot->flags & (HOT_INVALID_LEN | HOT_INVALID_MAX_LEN)) || (end - ptr < hot->ai_len))
+			{
+				parse_gs1_field(skipped, gs1_stream, ptr, end, error);
+				return -1;
+			}
+
+			//constant length bodies too: a FNC1 inside one is an error in parse_gs1_field
+			const char *body = ptr + hot->ai_len;
+			const char *next = (end - body > hot->body_max) ? body + hot->body_max : end;
+			next = find_gs1_fnc1(body, next);
+			if (next - body < hot->body_min)
+			{
+				parse_gs1_field(skipped, gs1_stream, ptr, end, error);
+				return -1;
+			}
+
+			while((next < end) && (*next == GS1::FNC1))
+				next++; //skip FNC1
+			ptr = next;
+		}
+
+		return found;
+	}
+}
@@ -0,0 +1,61 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_PROJECT_H__
+#define __GS1_PROJECT_H__
+
+#include "gs1-parse.h"
+
+namespace GS1
+{
+	//Projection parsing: only the wanted AIs are parsed, e.g.
+	//	GS1::ProjectionGS1 expiry;
+	//	int gtin = expiry.Add("01"), date = expiry.Add("17");
+	//	GS1::FieldView fields[2];
+	//	if (expiry.Parse(fields, scan, len, error) == 2) ...fields[gtin], fields[date]
+	//Other fields are skipped by a FNC1 search up to their spec length, with the same errors as parse_gs1,
+	//and the walk stops as soon as all wanted AIs were found (fields after them are not checked).
+	//Add AIs after load_spec(), slots are kept by spec id.
+	class ProjectionGS1
+	{
+	public:
+		ProjectionGS1() : count(0) {}
+		ProjectionGS1(const char *const *ais, int ai_count);
+
+		int Add(const char *ai); //AI::ai (e.g. "01", "310n"), returns its result slot or -1 if not in the spec
+		void Clear();
+		int GetCount() const { return count; } //result slots
+
+		//fields: GetCount() slots by Add() order, ai = 0 if not in the scan (first occurrence wins)
+		//returns the number of wanted AIs found, -1 on a stream error before all were found
+		int Parse(FieldView *fields, const char *gs1_stream, int len, ErrorView &error) const;
+		inline int Parse(FieldView *fields, const char *gs1_stream, ErrorView &error) const { return Parse(fields, gs1_stream, (int)strlen(gs1_stream), error); }
+
+	protected:
+		std::vector<short> slot_by_id; //by get_ai_id(), -1 - not wanted
+		int count;
+	};
+}
+
+#endif
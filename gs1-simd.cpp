@@ -0,0 +1,425 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-simd.h"
+#include "gs1-spec.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GS1_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(GS1_SIMD_X86) && defined(__GNUC__)
+#define GS1_TARGET_SSE2 __attribute__((target("sse2")))
+#define GS1_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define GS1_TARGET_SSE2
+#define GS1_TARGET_AVX2
+#endif
+
+#ifdef _MSC_VER
+#define GS1_CTZ(x) (int)_tzcnt_u32(x)
+#else
+#define GS1_CTZ(x) __builtin_ctz(x)
+#endif
+
+namespace GS1
+{
+	static const char * find_byte_scalar(const char *ptr, const char *end, char c)
+	{
+		while((ptr < end) && (*ptr != c))
+			ptr++;
+		return ptr;
+	}
+
+	static bool isstrdigit_scalar(const char *ptr, int len)
+	{
+		unsigned char bad = 0;
+		for(int i=0; i<len; i++)
+			bad |= (unsigned char)((unsigned char)(ptr[i] - '0') > 9);
+		return bad == 0;
+	}
+
+	//CSET82 bitmap: '!', '"', '%'..'?', 'A'..'Z', '_', 'a'..'z' (constant, no initialization order issues)
+	static const unsigned int cset82_bits[8] = {0x00000000, 0xFFFFFFE6, 0x87FFFFFE, 0x07FFFFFE, 0, 0, 0, 0};
+
+	//branchless: the scalar kernels are the whole check without SIMD
+	static bool isstrcset82_scalar(const char *ptr, int len)
+	{
+		unsigned int ok = 1;
+		for(int i=0; i<len; i++)
+		{
+			unsigned char c = (unsigned char)ptr[i];
+			ok &= cset82_bits[c >> 5] >> (c & 31);
+		}
+		return ok != 0;
+	}
+
+	//weights 3,1,3,... from the right, the check digit has weight 1: valid if the sum is 0 mod 10
+	static int check_mod10_scalar(const char *ptr, int len)
+	{
+		unsigned int bad = 0;
+		unsigned int sum = 0;
+		unsigned int weight = (len & 1) ? 1 : 3;
+		for(int i=0; i<len; i++)
+		{
+			unsigned int d = (unsigned char)(ptr[i] - '0');
+			bad |= d > 9;
+			sum += d * weight;
+			weight = 4 - weight;
+		}
+		if (bad)
+			return -1;
+		return (sum % 10) == 0;
+	}
+
+#ifdef GS1_SIMD_X86
+
+	GS1_TARGET_SSE2
+	static const char * find_byte_sse2(const char *ptr, const char *end, char c)
+	{
+		const __m128i needle = _mm_set1_epi8(c);
+		while(end - ptr >= 16)
+		{
+			__m128i v = _mm_loadu_si128((const __m128i*)ptr);
+			unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+			if (mask)
+				return ptr + GS1_CTZ(mask);
+			ptr += 16;
+		}
+		return find_byte_scalar(ptr, end, c);
+	}
+
+	//Loads never go past ptr + len, callers' buffers need no padding: a tail after full blocks
+	//is one load of the last 16 bytes (overlapping checked ones), 8 to 15 bytes are loaded
+	//as the first and the last 8 (overlapping too) and shorter strings are scalar.
+	GS1_TARGET_SSE2
+	static inline __m128i load_short_sse2(const char *ptr, int len)
+	{
+		return _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)ptr), _mm_loadl_epi64((const __m128i*)(ptr + len - 8)));
+	}
+
+	//digit: (c - '0') as unsigned byte <= 9
+	GS1_TARGET_SSE2
+	static bool isstrdigit_sse2(const char *ptr, int len)
+	{
+		if (len < 8)
+			return isstrdigit_scalar(ptr, len);
+
+		const __m128i zero = _mm_set1_epi8('0');
+		const __m128i nine = _mm_set1_epi8(9);
+		if (len < 16)
+		{
+			__m128i v = _mm_sub_epi8(load_short_sse2(ptr, len), zero);
+			return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, nine), nine)) == 0xFFFF;
+		}
+
+		const char *last = ptr + len - 16;
+		while(len >= 16)
+		{
+			__m128i v = _mm_sub_epi8(_mm_loadu_si128((const __m128i*)ptr), zero);
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, nine), nine)) != 0xFFFF)
+				return false;
+			ptr += 16;
+			len -= 16;
+		}
+		if (len > 0)
+		{
+			__m128i v = _mm_sub_epi8(_mm_loadu_si128((const __m128i*)last), zero);
+			return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, nine), nine)) == 0xFFFF;
+		}
+		return true;
+	}
+
+	//chars outside CSET82 as movemask bits
+	GS1_TARGET_SSE2
+	static inline unsigned int cset82_mask_sse2(__m128i v)
+	{
+		const __m128i ones = _mm_set1_epi8(-1);
+		__m128i r = _mm_sub_epi8(v, _mm_set1_epi8(0x21));
+		__m128i in_range = _mm_cmpeq_epi8(_mm_max_epu8(r, _mm_set1_epi8(0x59)), _mm_set1_epi8(0x59));
+		__m128i d = _mm_sub_epi8(v, _mm_set1_epi8('#')); //'#', '$'
+		__m128i b = _mm_sub_epi8(v, _mm_set1_epi8('[')); //'[', '\\', ']', '^'
+		__m128i excluded = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(1)), d), _mm_cmpeq_epi8(_mm_min_epu8(b, _mm_set1_epi8(3)), b)),
+			_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('@')), _mm_cmpeq_epi8(v, _mm_set1_epi8('`'))));
+		return (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_xor_si128(in_range, ones), excluded));
+	}
+
+	GS1_TARGET_SSE2
+	static bool isstrcset82_sse2(const char *ptr, int len)
+	{
+		if (len < 8)
+			return isstrcset82_scalar(ptr, len);
+		if (len < 16)
+			return cset82_mask_sse2(load_short_sse2(ptr, len)) == 0;
+
+		const char *last = ptr + len - 16;
+		while(len >= 16)
+		{
+			if (cset82_mask_sse2(_mm_loadu_si128((const __m128i*)ptr)))
+				return false;
+			ptr += 16;
+			len -= 16;
+		}
+		if (len > 0)
+			return cset82_mask_sse2(_mm_loadu_si128((const __m128i*)last)) == 0;
+		return true;
+	}
+
+	//8 to 32 digits as two 16 byte blocks, the second one ends at ptr + len (8 to 15 digits: two 8 byte halves
+	//as in load_short_sse2): its lanes already in the first block (half) are zeroed
+	GS1_TARGET_SSE2
+	static int check_mod10_sse2(const char *ptr, int len)
+	{
+		if ((len < 8) || (len > 32))
+			return check_mod10_scalar(ptr, len);
+
+		const __m128i zero = _mm_set1_epi8('0');
+		const __m128i nine = _mm_set1_epi8(9);
+		const __m128i index = _mm_set_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+		const __m128i nul = _mm_setzero_si128();
+
+		//lane i weight: 3 if its distance from the last digit is odd (len - 1 - i in the first block,
+		//15 - i in a block ending at ptr + len)
+		const __m128i odd_weights = _mm_set_epi16(3, 1, 3, 1, 3, 1, 3, 1);
+		const __m128i even_weights = _mm_set_epi16(1, 3, 1, 3, 1, 3, 1, 3);
+		const __m128i weights = (len & 1) ? odd_weights : even_weights;
+
+		__m128i d;
+		__m128i sum;
+		unsigned int bad;
+		if (len < 16)
+		{
+			__m128i fresh = _mm_or_si128(_mm_cmplt_epi8(index, _mm_set1_epi8(8)), _mm_cmpgt_epi8(index, _mm_set1_epi8((char)(23 - len))));
+			d = _mm_and_si128(_mm_sub_epi8(load_short_sse2(ptr, len), zero), fresh);
+			bad = ~(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(d, nine), nine)) & 0xFFFF;
+			sum = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(d, nul), weights), _mm_madd_epi16(_mm_unpackhi_epi8(d, nul), even_weights));
+		}
+		else
+		{
+			d = _mm_sub_epi8(_mm_loadu_si128((const __m128i*)ptr), zero);
+			bad = ~(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(d, nine), nine)) & 0xFFFF;
+			sum = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(d, nul), weights), _mm_madd_epi16(_mm_unpackhi_epi8(d, nul), weights));
+			if (len > 16)
+			{
+				__m128i fresh = _mm_cmpgt_epi8(index, _mm_set1_epi8((char)(31 - len)));
+				d = _mm_and_si128(_mm_sub_epi8(_mm_loadu_si128((const __m128i*)(ptr + len - 16)), zero), fresh);
+				bad |= ~(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(d, nine), nine)) & 0xFFFF;
+				sum = _mm_add_epi32(sum, _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(d, nul), even_weights), _mm_madd_epi16(_mm_unpackhi_epi8(d, nul), even_weights)));
+			}
+		}
+		if (bad)
+			return -1;
+
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+		return (_mm_cvtsi128_si32(sum) % 10) == 0;
+	}
+
+	GS1_TARGET_AVX2
+	static const char * find_byte_avx2(const char *ptr, const char *end, char c)
+	{
+		const __m256i needle = _mm256_set1_epi8(c);
+		while(end - ptr >= 32)
+		{
+			__m256i v = _mm256_loadu_si256((const __m256i*)ptr);
+			unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle));
+			if (mask)
+				return ptr + GS1_CTZ(mask);
+			ptr += 32;
+		}
+		_mm256_zeroupper(); //the SSE tails are not VEX encoded: clear the upper state, or every SSE op pays the AVX-SSE transition
+		return find_byte_sse2(ptr, end, c);
+	}
+
+	GS1_TARGET_AVX2
+	static bool isstrdigit_avx2(const char *ptr, int len)
+	{
+		if (len < 32)
+			return isstrdigit_sse2(ptr, len);
+
+		const __m256i zero = _mm256_set1_epi8('0');
+		const __m256i nine = _mm256_set1_epi8(9);
+		const char *last = ptr + len - 32; //tail: the last 32 bytes, as in the SSE2 kernels
+		for(;;)
+		{
+			__m256i v = _mm256_sub_epi8(_mm256_loadu_si256((const __m256i*)ptr), zero);
+			if ((unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(v, nine), nine)) != 0xFFFFFFFFu)
+				return false;
+			if (ptr == last)
+				return true;
+			ptr = (last - ptr > 32) ? ptr + 32 : last;
+		}
+	}
+
+	GS1_TARGET_AVX2
+	static bool isstrcset82_avx2(const char *ptr, int len)
+	{
+		if (len < 32)
+			return isstrcset82_sse2(ptr, len);
+
+		const __m256i ones = _mm256_set1_epi8(-1);
+		const char *last = ptr + len - 32;
+		for(;;)
+		{
+			__m256i v = _mm256_loadu_si256((const __m256i*)ptr);
+			__m256i r = _mm256_sub_epi8(v, _mm256_set1_epi8(0x21));
+			__m256i in_range = _mm256_cmpeq_epi8(_mm256_max_epu8(r, _mm256_set1_epi8(0x59)), _mm256_set1_epi8(0x59));
+			__m256i d = _mm256_sub_epi8(v, _mm256_set1_epi8('#'));
+			__m256i b = _mm256_sub_epi8(v, _mm256_set1_epi8('['));
+			__m256i excluded = _mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(1)), d), _mm256_cmpeq_epi8(_mm256_min_epu8(b, _mm256_set1_epi8(3)), b)),
+				_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('@')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('`'))));
+			if (_mm256_movemask_epi8(_mm256_or_si256(_mm256_xor_si256(in_range, ones), excluded)))
+				return false;
+			if (ptr == last)
+				return true;
+			ptr = (last - ptr > 32) ? ptr + 32 : last;
+		}
+	}
+
+	static int detect_simd_level()
+	{
+#ifdef _MSC_VER
+		int regs[4];
+		__cpuid(regs, 0);
+		int max_leaf = regs[0];
+
+		__cpuid(regs, 1);
+		int level = (regs[3] & (1 << 26)) ? SIMD_SSE2 : SIMD_SCALAR;
+
+		//AVX2 needs OS support of YMM state (OSXSAVE + XCR0)
+		bool avx_os = (regs[2] & (1 << 27)) && (regs[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+		if (avx_os && (max_leaf >= 7))
+		{
+			__cpuidex(regs, 7, 0);
+			if (regs[1] & (1 << 5))
+				level = SIMD_AVX2;
+		}
+		return level;
+#else
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+			return SIMD_AVX2;
+		if (__builtin_cpu_supports("sse2"))
+			return SIMD_SSE2;
+		return SIMD_SCALAR;
+#endif
+	}
+
+#else
+
+	static int detect_simd_level()
+	{
+		return SIMD_SCALAR;
+	}
+
+#endif
+
+	struct KernelsGS1
+	{
+		int level;
+		const char * (*find_byte)(const char *ptr, const char *end, char c);
+		bool (*isstrdigit)(const char *ptr, int len);
+		bool (*isstrcset82)(const char *ptr, int len);
+		int (*check_mod10)(const char *ptr, int len);
+	};
+
+	//constant-initialized, so the scalar kernels work even before the selection below
+	static KernelsGS1 kernels = {SIMD_SCALAR, find_byte_scalar, isstrdigit_scalar, isstrcset82_scalar, check_mod10_scalar};
+	static const int supported_level = detect_simd_level();
+	static const bool kernels_selected = set_simd_level(supported_level);
+
+	int get_simd_level()
+	{
+		return kernels.level;
+	}
+
+	int get_simd_level_supported()
+	{
+		return supported_level;
+	}
+
+	bool set_simd_level(int level)
+	{
+		if ((level < SIMD_SCALAR) || (level > supported_level))
+			return false;
+
+		switch(level)
+		{
+		default:
+		case SIMD_SCALAR:
+			kernels.find_byte = find_byte_scalar;
+			kernels.isstrdigit = isstrdigit_scalar;
+			kernels.isstrcset82 = isstrcset82_scalar;
+			kernels.check_mod10 = check_mod10_scalar;
+			break;
+#ifdef GS1_SIMD_X86
+		case SIMD_SSE2:
+			kernels.find_byte = find_byte_sse2;
+			kernels.isstrdigit = isstrdigit_sse2;
+			kernels.isstrcset82 = isstrcset82_sse2;
+			kernels.check_mod10 = check_mod10_sse2;
+			break;
+		case SIMD_AVX2:
+			kernels.find_byte = find_byte_avx2;
+			kernels.isstrdigit = isstrdigit_avx2;
+			kernels.isstrcset82 = isstrcset82_avx2;
+			kernels.check_mod10 = check_mod10_sse2; //keys are at most 18 digits
+			break;
+#endif
+		}
+		kernels.level = level;
+		return true;
+	}
+
+	const char * find_gs1_fnc1(const char *ptr, const char *end)
+	{
+		return kernels.find_byte(ptr, end, GS1::FNC1);
+	}
+
+	const char * find_byte(const char *ptr, const char *end, char c)
+	{
+		return kernels.find_byte(ptr, end, c);
+	}
+
+	bool isstrdigit(const char *ptr, int len)
+	{
+		return kernels.isstrdigit(ptr, len);
+	}
+
+	bool isstrcset82(const char *ptr, int len)
+	{
+		return kernels.isstrcset82(ptr, len);
+	}
+
+	int check_mod10(const char *ptr, int len)
+	{
+		return kernels.check_mod10(ptr, len);
+	}
+}
@@ -0,0 +1,57 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_SIMD_H__
+#define __GS1_SIMD_H__
+
+namespace GS1
+{
+	//Scanning kernels used by the parser.
+	//The best implementation (AVX2, SSE2 or scalar) is selected at startup by CPU features.
+
+	//first FNC1 in [ptr, end) or end
+	const char* find_gs1_fnc1(const char *ptr, const char *end);
+
+	//first c in [ptr, end) or end (e.g. line splitting)
+	const char* find_byte(const char *ptr, const char *end, char c);
+
+	//true if all len chars are '0'..'9' (len chars must be readable, NUL is not a digit)
+	bool isstrdigit(const char *ptr, int len);
+
+	//true if all len chars are in GS1 character set 82 (Figure 7.11-1)
+	bool isstrcset82(const char *ptr, int len);
+
+	//len digits ending with a GS1 mod-10 check digit: 1 - valid, 0 - wrong check digit, -1 - not all digits
+	int check_mod10(const char *ptr, int len);
+
+	const int SIMD_SCALAR = 0;
+	const int SIMD_SSE2 = 1;
+	const int SIMD_AVX2 = 2;
+
+	int get_simd_level(); //selected kernels
+	int get_simd_level_supported(); //best kernels the CPU can run
+	bool set_simd_level(int level); //force kernels (tests/benchmarks), false if not supported; not thread safe
+}
+
+#endif
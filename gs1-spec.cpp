@@ -1,394 +1,786 @@
-/*
-MIT License
-
-Copyright (c) 2021 Serge Reinov
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in all
-copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-SOFTWARE.
-*/
-
-#include "gs1-spec.h"
-
-namespace GS1
-{
-	const AI ai_list[] = 
-	{
-		// ai,		desc_content,		desc_format,		FNC1_required,		data_title,		field_len,		max_field_len_optional
-
-
-		{"00", "Serial Shipping Container Code (SSCC)",		"N2+N18", false, "SSCC", 2+18, 0, GS1_STRING},
-		{"01", "Global Trade Item Number (GTIN)",			"N2+N14", false, "GTIN", 2+14, 0, GS1_STRING},
-		{"02", "GTIN of contained trade items",				"N2+N14", false, "CONTENT", 2+14, 0, GS1_STRING},
-		
-		{"10", "Batch or lot number",			"N2+X..20", true, "BATCH/LOT", 2+1, 2+20, GS1_STRING},
-		{"11", "Production date (YYMMDD)",		"N2+N6", false, "PROD DATE", 2+6, 0, GS1_DATE},
-		{"12", "Due date (YYMMDD)",				"N2+N6", false, "DUE DATE", 2+6, 0, GS1_DATE},
-		{"13", "Packaging date (YYMMDD)",		"N2+N6", false, "PACK DATE", 2+6, 0, GS1_DATE},
-		{"15", "Best before date (YYMMDD)",		"N2+N6", false, "BEST BEFORE/BEST BY", 2+6, 0, GS1_DATE},
-		{"16", "Sell by date (YYMMDD)",			"N2+N6", false, "SELL BY", 2+6, 0, GS1_DATE},
-		{"17", "Expiration date (YYMMDD)",		"N2+N6", false, "USE BY/EXPIRY", 2+6, 0, GS1_DATE},
-
-		{"20", "Internal product variant", 		"N2+N2", false, "VARIANT", 2+2, 0, GS1_STRING},
-		{"21", "Serial number",					"N2+X..20", true, "SERIAL", 2+1, 2+20, GS1_STRING},
-		{"22", "Consumer product variant",		"N2+X..20", true, "CPV", 2+1, 2+20, GS1_STRING},
-
-		{"240", "Additional item identification",	"N3+X..30", true, "ADDITIONAL ID", 3+1, 3+30, GS1_STRING},
-		{"241", "Customer part number",				"N3+X..30", true, "CUST. PART NO.", 3+1, 3+30, GS1_STRING},
-		{"242", "Made-to-Order variation number",	"N3+N..6", true, "MTO VARIANT", 3+1, 3+6, GS1_STRING},
-		{"243", "Packaging component number",		"N3+X..20", true, "PCN", 3+1, 3+20, GS1_STRING},
-		{"250", "Secondary serial number",			"N3+X..30", true, "SECONDARY SERIAL", 3+1, 3+30, GS1_STRING},
-		{"251", "Reference to source entity",		"N3+X..30", true, "REF. TO SOURCE", 3+1, 3+30, GS1_STRING},
-		{"253", "Global Document Type Identifier (GDTI)",	"N3+N13+X..17", true, "GDTI", 3+13+1, 3+13+17, GS1_STRING},
-		{"254", "GLN extension component",					"N3+X..20", true, "GLN EXTENSION COMPONENT", 3+1, 3+20, GS1_STRING},
-		{"255", "Global Coupon Number (GCN)",				"N3+N13+N..12", true, "GCN", 3+13+1, 3+13+12, GS1_STRING},
-
-		{"30", "Variable count of items (variable measure trade item)",	"N2+N..8", true, "VAR. COUNT", 2+1, 2+8, GS1_STRING},
-
-		//310n Net weight, kilograms (variable measure trade item) N4+N6  (no)  NET WEIGHT (kg)
-		//{"3100", "Net weight, kilograms",	"N4+N6", false, "NET WEIGHT (kg)", 4+6, 0, GS1_STRING}, // 000000. kg
-		//{"3101", "Net weight, kilograms",	"N4+N6", false, "NET WEIGHT (kg)", 4+6, 0, GS1_STRING}, // 00000.0 kg
-	 	//{"3102", "Net weight, kilograms",	"N4+N6", false, "NET WEIGHT (kg)", 4+6, 0, GS1_STRING}, // 0000.00 kg
-		//{"3103", "Net weight, kilograms",	"N4+N6", false, "NET WEIGHT (kg)", 4+6, 0, GS1_STRING}, // 000.000 kg
-		//{"3104", "Net weight, kilograms",	"N4+N6", false, "NET WEIGHT (kg)", 4+6, 0, GS1_STRING}, // 00.0000 kg
-		//{"3105", "Net weight, kilograms",	"N4+N6", false, "NET WEIGHT (kg)", 4+6, 0, GS1_STRING}, // 0.00000 kg
-		//{"3106", "Net weight, kilograms",	"N4+N6", false, "NET WEIGHT (kg)", 4+6, 0, GS1_STRING}, // .000000 kg
-		{"310n", "Net weight, kilograms",	"N4+N6", false, "NET WEIGHT (kg)", 4+6, 0, GS1_DECIMAL},
-
-		//311n	Length or first dimension, metres (variable measure trade item)	N4+N6  (no)  LENGTH (m)
-		{"311n", "Length or first dimension, metres",	"N4+N6", false, "LENGTH (m)", 4+6, 0, GS1_DECIMAL},
-
-		//312n Width, diameter, or second dimension, metres (variable measure trade item)  N4+N6  (no)   WIDTH (m)
-		{"312n", "Width, diameter, or second dimension, metres", "N4+N6", false, "WIDTH (m)", 4+6, 0, GS1_DECIMAL},
-
-		//313n	Depth, thickness, height, or third dimension, metres (variable measure trade item)	N4+N6  (no)  HEIGHT (m)
-		{"313n", "Depth, thickness, height, or third dimension, metres", "N4+N6", false, "HEIGHT (m)", 4+6, 0, GS1_DECIMAL},
-
-		//314n	Area, square metres (variable measure trade item)	N4+N6    AREA (m2)
-		{"314n", "Area, square metres", "N4+N6", false, "AREA (m2)", 4+6, 0, GS1_DECIMAL},
-		
-		//315n	Net volume, litres (variable measure trade item)  N4+N6    NET VOLUME (l)
-		{"315n", "Net volume, litres", "N4+N6", false, "NET VOLUME (l)", 4+6, 0, GS1_DECIMAL},
-
-		//316n	Net volume, cubic metres (variable measure trade item)	N4+N6    NET VOLUME (m3)
-		{"316n", "Net volume, cubic metres", "N4+N6", false, "NET VOLUME (m3)", 4+6, 0, GS1_DECIMAL},
-		
-		//320n	Net weight, pounds (variable measure trade item)  N4+N6		NET WEIGHT (lb)
-		{"320n", "Net weight, pounds", "N4+N6", false, "NET WEIGHT (lb)", 4+6, 0, GS1_DECIMAL},
-		
-		//321n	Length or first dimension, inches (variable measure trade item)	N4+N6 LENGTH (i)
-		{"321n", "Length or first dimension, inches", "N4+N6", false, "LENGTH (i)", 4+6, 0, GS1_DECIMAL},
-
-		//322n	Length or first dimension, feet (variable measure trade item)	N4+N6	LENGTH (f) 
-		{"322n", "Length or first dimension, feet", "N4+N6", false, "LENGTH (f)", 4+6, 0, GS1_DECIMAL},
-		
-		//323n	Length or first dimension, yards (variable measure trade item)	N4+N6 LENGTH (y)
-		{"323n", "Length or first dimension, yards", "N4+N6", false, "LENGTH (y)", 4+6, 0, GS1_DECIMAL},
-		
-		//324n	Width, diameter, or second dimension, inches (variable measure trade item)	N4+N6 WIDTH (i)
-		{"324n", "Width, diameter, or second dimension, inches", "N4+N6", false, "WIDTH (i)", 4+6, 0, GS1_DECIMAL},
-
-		//325n	Width, diameter, or second dimension, feet (variable measure trade item)	N4+N6	WIDTH (f)
-		{"325n", "Width, diameter, or second dimension, feet", "N4+N6", false, "WIDTH (f)", 4+6, 0, GS1_DECIMAL},
-		
-		//326n	Width, diameter, or second dimension, yards (variable measure trade item)	N4+N6 WIDTH (y)
-		{"326n", "Width, diameter, or second dimension, yards", "N4+N6", false, "WIDTH (y)", 4+6, 0, GS1_DECIMAL},
-		
-		//327n	Depth, thickness, height, or third dimension, inches (variable measure trade item)	N4+N6 HEIGHT (i)
-		{"327n", "Depth, thickness, height, or third dimension, inches", "N4+N6", false, "HEIGHT (i)", 4+6, 0, GS1_DECIMAL},
-		
-		//328n	Depth, thickness, height, or third dimension, feet (variable measure trade item)	N4+N6 HEIGHT (f)
-		{"328n", "Depth, thickness, height, or third dimension, feet", "N4+N6", false, "HEIGHT (f)", 4+6, 0, GS1_DECIMAL},
-		
-		//329n	Depth, thickness, height, or third dimension, yards (variable measure trade item)	N4+N6	HEIGHT (y)
-		{"329n", "Depth, thickness, height, or third dimension, yards", "N4+N6", false, "HEIGHT (y)", 4+6, 0, GS1_DECIMAL},
-		
-		//330n	Logistic weight, kilograms  N4+N6    GROSS WEIGHT (kg)
-		{"330n", "Logistic weight, kilograms", "N4+N6", false, "GROSS WEIGHT (kg)", 4+6, 0, GS1_DECIMAL},
-		
-		//331n	Length or first dimension, metres  N4+N6    LENGTH (m), log
-		{"331n", "Length or first dimension, metres", "N4+N6", false, "LENGTH (m), log", 4+6, 0, GS1_DECIMAL},
-
-		//332n	Width, diameter, or second dimension, metres  N4+N6    WIDTH (m), log
-		{"332n", "Width, diameter, or second dimension, metres", "N4+N6", false, "WIDTH (m), log", 4+6, 0, GS1_DECIMAL},
-
-		//333n	Depth, thickness, height, or third dimension, metres	N4+N6    HEIGHT (m), log
-		{"333n", "Depth, thickness, height, or third dimension, metres", "N4+N6", false, "HEIGHT (m), log", 4+6, 0, GS1_DECIMAL},
-		
-		//334n	Area, square metres  N4+N6    AREA (m2), log
-		{"334n", "Area, square metres", "N4+N6", false, "AREA (m2), log", 4+6, 0, GS1_DECIMAL},
-		
-		//335n	Logistic volume, litres  N4+N6    VOLUME (l), log
-		{"335n", "Logistic volume, litres", "N4+N6", false, "VOLUME (l), log", 4+6, 0, GS1_DECIMAL},
-		
-		//336n	Logistic volume, cubic metres  N4+N6    VOLUME (m3), log
-		{"336n", "Logistic volume, cubic metres", "N4+N6", false, "VOLUME (m3), log", 4+6, 0, GS1_DECIMAL},
-		
-		//337n	Kilograms per square metre  N4+N6    KG PER m2
-		{"337n", "Kilograms per square metre", "N4+N6", false, "KG PER m2", 4+6, 0, GS1_DECIMAL},
-		
-		//340n	Logistic weight, pounds  N4+N6    GROSS WEIGHT (lb)
-		{"340n", "Logistic weight, pounds", "N4+N6", false, "GROSS WEIGHT (lb)", 4+6, 0, GS1_DECIMAL},
-		
-		//341n	Length or first dimension, inches  N4+N6    LENGTH (i), log
-		{"341n", "Length or first dimension, inches", "N4+N6", false, "LENGTH (i), log", 4+6, 0, GS1_DECIMAL},
-		
-		//342n	Length or first dimension, feet  N4+N6    LENGTH (f), log
-		{"342n", "Length or first dimension, feet", "N4+N6", false, "LENGTH (f), log", 4+6, 0, GS1_DECIMAL},
-		
-		//343n	Length or first dimension, yards  N4+N6    LENGTH (y), log
-		{"343n", "Length or first dimension, yards", "N4+N6", false, "LENGTH (y), log", 4+6, 0, GS1_DECIMAL},
-		
-		//344n	Width, diameter, or second dimension, inches  N4+N6    WIDTH (i), log
-		{"344n", "Width, diameter, or second dimension, inches", "N4+N6", false, "WIDTH (i), log", 4+6, 0, GS1_DECIMAL},
-		
-		//345n	Width, diameter, or second dimension, feet  N4+N6    WIDTH (f), log
-		{"345n", "Width, diameter, or second dimension, feet", "N4+N6", false, "WIDTH (f), log", 4+6, 0, GS1_DECIMAL},
-		
-		//346n	Width, diameter, or second dimension, yard  N4+N6    WIDTH (y), log
-		{"346n", "Width, diameter, or second dimension, yard", "N4+N6", false, "WIDTH (y), log", 4+6, 0, GS1_DECIMAL},
-		
-		//347n	Depth, thickness, height, or third dimension, inches	N4+N6    HEIGHT (i), log
-		{"347n", "Depth, thickness, height, or third dimension, inches", "N4+N6", false, "HEIGHT (i), log", 4+6, 0, GS1_DECIMAL},
-
-		//348n	Depth, thickness, height, or third dimension, feet  N4+N6    HEIGHT (f), log
-		{"348n", "Depth, thickness, height, or third dimension, feet", "N4+N6", false, "HEIGHT (f), log", 4+6, 0, GS1_DECIMAL},
-		
-		//349n	Depth, thickness, height, or third dimension, yards		N4+N6    HEIGHT (y), log
-		{"349n", "Depth, thickness, height, or third dimension, yards", "N4+N6", false, "HEIGHT (y), log", 4+6, 0, GS1_DECIMAL},
-		
-		//350n	Area, square inches (variable measure trade item)	N4+N6    AREA (i2)
-		{"350n", "Area, square inches", "N4+N6", false, "AREA (i2)", 4+6, 0, GS1_DECIMAL},
-		
-		//351n	Area, square feet (variable measure trade item)  N4+N6    AREA (f2)
-		{"351n", "Area, square feet", "N4+N6", false, "AREA (f2)", 4+6, 0, GS1_DECIMAL},
-		
-		//352n	Area, square yards (variable measure trade item)  N4+N6    AREA (y2)
-		{"352n", "Area, square yards", "N4+N6", false, "AREA (y2)", 4+6, 0, GS1_DECIMAL},
-		
-		//353n	Area, square inches  N4+N6 AREA (i2), log
-		{"353n", "Area, square inches", "N4+N6", false, "AREA (i2), log", 4+6, 0, GS1_DECIMAL},
-		
-		//354n	Area, square feet  N4+N6    AREA (f2), log
-		{"354n", "Area, square feet", "N4+N6", false, "AREA (f2), log", 4+6, 0, GS1_DECIMAL},
-		
-		//355n	Area, square yards  N4+N6    AREA (y2), log
-		{"355n", "Area, square yards", "N4+N6", false, "AREA (y2), log", 4+6, 0, GS1_DECIMAL},
-		
-		//356n	Net weight, troy ounces (variable measure trade item)	N4+N6    NET WEIGHT (t)
-		{"356n", "Net weight, troy ounces", "N4+N6", false, "NET WEIGHT (t)", 4+6, 0, GS1_DECIMAL},
-		
-		//357n	Net weight (or volume), ounces (variable measure trade item)	N4+N6    NET VOLUME (oz)
-		{"357n", "Net weight (or volume), ounces", "N4+N6", false, "NET VOLUME (oz)", 4+6, 0, GS1_DECIMAL},
-		
-		//360n	Net volume, quarts (variable measure trade item)  N4+N6    NET VOLUME (q)
-		{"360n", "Net volume, quarts", "N4+N6", false, "NET VOLUME (q)", 4+6, 0, GS1_DECIMAL},
-		
-		//361n	Net volume, gallons U.S. (variable measure trade item)	N4+N6    NET VOLUME (g)
-		{"361n", "Net volume, gallons U.S.", "N4+N6", false, "NET VOLUME (g)", 4+6, 0, GS1_DECIMAL},
-		
-		//362n	Logistic volume, quarts  N4+N6    VOLUME (q), log
-		{"362n", "Logistic volume, quarts", "N4+N6", false, "VOLUME (q), log", 4+6, 0, GS1_DECIMAL},
-		
-		//363n	Logistic volume, gallons U.S.  N4+N6    VOLUME (g), log
-		{"363n", "Logistic volume, gallons U.S.", "N4+N6", false, "VOLUME (g), log", 4+6, 0, GS1_DECIMAL},
-		
-		//364n	Net volume, cubic inches (variable measure trade item)	N4+N6    VOLUME (i3)
-		{"364n", "Net volume, cubic inches", "N4+N6", false, "VOLUME (i3)", 4+6, 0, GS1_DECIMAL},
-		
-		//365n	Net volume, cubic feet (variable measure trade item)	N4+N6    VOLUME (f3)
-		{"365n", "Net volume, cubic feet", "N4+N6", false, "VOLUME (f3)", 4+6, 0, GS1_DECIMAL},
-		
-		//366n	Net volume, cubic yards (variable measure trade item)	N4+N6    VOLUME (y3)
-		{"366n", "Net volume, cubic yards", "N4+N6", false, "VOLUME (y3)", 4+6, 0, GS1_DECIMAL},
-		
-		//367n	Logistic volume, cubic inches  N4+N6    VOLUME (i3), log
-		{"367n", "Logistic volume, cubic inches", "N4+N6", false, "VOLUME (i3), log", 4+6, 0, GS1_DECIMAL},
-		
-		//368n	Logistic volume, cubic feet  N4+N6    VOLUME (f3), log
-		{"368n", "Logistic volume, cubic feet", "N4+N6", false, "VOLUME (f3), log", 4+6, 0, GS1_DECIMAL},
-		
-		//369n	Logistic volume, cubic yards  N4+N6    VOLUME (y3), log
-		{"369n", "Logistic volume, cubic yards", "N4+N6", false, "VOLUME (y3), log", 4+6, 0, GS1_DECIMAL},
-
-		{"37", "Count of trade items", "N2+N..8", true, "COUNT", 2+1, 2+8, GS1_STRING},
-
-		//390n	Applicable amount payable or Coupon value, local currency	N4+N..15	(FNC1)  AMOUNT
-		{"390n", "Applicable amount payable or Coupon value, local currency", "N4+N..15", true, "AMOUNT", 4+1, 4+15, GS1_DECIMAL},
-
-		//391n	Applicable amount payable with ISO currency code	N4+N3+N..15	(FNC1)  AMOUNT
-		{"391n", "Applicable amount payable with ISO currency code", "N4+N3+N..15", true, "AMOUNT", 4+3+1, 4+3+15, GS1_DECIMAL},
-
-		//392n	Applicable amount payable, single monetary area (variable measure trade item)	N4+N..15	(FNC1)  PRICE
-		{"392n", "Applicable amount payable, single monetary area", "N4+N..15", true, "PRICE", 4+1, 4+15, GS1_DECIMAL},
-		
-		//393n	Applicable amount payable with ISO currency code (variable measure trade item)	N4+N3+N..15	(FNC1)  PRICE
-		{"393n", "Applicable amount payable with ISO currency code", "N4+N3+N..15", true, "PRICE", 4+3+1, 4+3+15, GS1_DECIMAL},
-		
-		//394n	Percentage discount of a coupon  N4+N4  (FNC1)  PRCNT OFF
-		{"394n", "Percentage discount of a coupon", "N4+N4", true, "PRCNT OFF", 4+4, 0, GS1_DECIMAL},
-		
-		{"400", "Customer's purchase order number", "N3+X..30", true, "ORDER NUMBER", 3+1, 3+30, GS1_STRING},
-		{"401", "Global Identification Number for Consignment (GINC)", "N3+X..30", true, "GINC", 3+1, 3+30, GS1_STRING},
-		{"402", "Global Shipment Identification Number (GSIN)", "N3+N17", true, "GSIN", 3+17, 0, GS1_STRING},
-		{"403", "Routing code", "N3+X..30", true, "ROUTE", 3+1, 3+30, GS1_STRING},
-
-		{"410", "Ship to - Deliver to Global Location Number", "N3+N13", false, "SHIP TO LOC", 3+13, 0, GS1_STRING},
-		{"411", "Bill to - Invoice to Global Location Number", "N3+N13", false, "BILL TO", 3+13, 0, GS1_STRING},
-		{"412", "Purchased from Global Location Number", "N3+N13", false, "PURCHASE FROM", 3+13, 0, GS1_STRING},
-		{"413", "Ship for - Deliver for - Forward to Global Location Number", "N3+N13", false, "SHIP FOR LOC", 3+13, 0, GS1_STRING},
-		{"414", "Identification of a physical location - Global Location Number", "N3+N13", false, "LOC No", 3+13, 0, GS1_STRING},
-		{"415", "Global Location Number of the invoicing party", "N3+N13", false, "PAY TO", 3+13, 0, GS1_STRING},
-		{"416", "GLN of the production or service location", "N3+N13", false, "PROD/SERV LOC", 3+13, 0, GS1_STRING},
-
-
-		{"420", "Ship to - Deliver to postal code within a single postal authority", "N3+X..20", true, "SHIP TO POST", 3+1, 3+20, GS1_STRING},
-		{"421", "Ship to - Deliver to postal code with ISO country code", "N3+N3+X..9", true, "SHIP TO POST", 3+3+1, 3+3+9, GS1_STRING},
-		{"422", "Country of origin of a trade item", "N3+N3", true, "ORIGIN", 3+3, 0, GS1_STRING},
-		{"423", "Country of initial processing", "N3+N3+N..12", true, "COUNTRY - INITIAL PROCESS", 3+3+1, 3+3+12, GS1_STRING},
-		{"424", "Country of processing", "N3+N3", true, "COUNTRY - PROCESS", 3+3, 0, GS1_STRING},
-		{"425", "Country of disassembly", "N3+N3+N..12", true, "COUNTRY - DISASSEMBLY", 3+3+1, 3+3+12, GS1_STRING},
-		{"426", "Country covering full process chain", "N3+N3", true, "COUNTRY  FULL PROCESS", 3+3, 0, GS1_STRING},
-		{"427", "Country subdivision Of origin", "N3+X..3", true, "ORIGIN SUBDIVISION", 3+1, 3+3, GS1_STRING},
-
-		{"7001", "NATO Stock Number (NSN)", "N4+N13", true, "NSN", 4+13, 0, GS1_STRING},
-		{"7002", "UN/ECE meat carcasses and cuts classification", "N4+X..30", true, "MEAT CUT", 4+1, 4+30, GS1_STRING},
-		{"7003", "Expiration date and time", "N4+N10", true, "EXPIRY TIME", 4+10, 0, GS1_STRING},
-		{"7004", "Active potency", "N4+N..4", true, "ACTIVE POTENCY", 4+1, 4+4, GS1_STRING},
-		{"7005", "Catch area", "N4+X..12", true, "CATCH AREA", 4+1, 4+12, GS1_STRING},
-		{"7006", "First freeze date", "N4+N6", true, "FIRST FREEZE DATE", 4+6, 0, GS1_STRING},
-		{"7007", "Harvest date", "N4+N6..12", true, "HARVEST DATE", 4+6, 4+12, GS1_STRING},
-		{"7008", "Species for fishery purposes", "N4+X..3", true, "AQUATIC SPECIES", 4+1, 4+3, GS1_STRING},
-		{"7009", "Fishing gear type", "N4+X..10", true, "FISHING GEAR TYPE", 4+1, 4+10, GS1_STRING},
-		{"7010", "Production method", "N4+X..2", true, "PROD METHOD", 4+1, 4+2, GS1_STRING},
-		{"7020", "Refurbishment lot ID", "N4+X..20", true, "REFURB LOT", 4+1, 4+20, GS1_STRING},
-		{"7021", "Functional status", "N4+X..20", true, "FUNC STAT", 4+1, 4+20, GS1_STRING},
-		{"7022", "Revision status", "N4+X..20", true, "REV STAT", 4+1, 4+20, GS1_STRING},
-		{"7023", "Global Individual Asset Identifier (GIAI) of an assembly", "N4+X..30", true, "GIAI  ASSEMBLY", 4+1, 4+30, GS1_STRING},
-
-		//703s  Number of processor with ISO Country Code  N4+N3+X..27  (FNC1)  PROCESSOR # s
-		//UNSUPPORTED yet
-
-		{"710", "National Healthcare Reimbursement Number (NHRN)  Germany PZN", "N3+X..20", true, "NHRN PZN", 3+1, 3+20, GS1_STRING},
-		{"711", "National Healthcare Reimbursement Number (NHRN)  France CIP", "N3+X..20", true, "NHRN CIP", 3+1, 3+20, GS1_STRING},
-		{"712", "National Healthcare Reimbursement Number (NHRN)  Spain CN", "N3+X..20", true, "NHRN CN", 3+1, 3+20, GS1_STRING},
-		{"713", "National Healthcare Reimbursement Number (NHRN)  Brasil DRN", "N3+X..20", true, "NHRN DRN", 3+1, 3+20, GS1_STRING},
-
-		{"8001", "Roll products (width, length, core diameter, direction, splices)", "N4+N14", true, "DIMENSIONS", 4+14, 0, GS1_STRING},
-		{"8002", "Cellular mobile telephone identifier", "N4+X..20", true, "CMT No", 4+1, 4+20, GS1_STRING},
-		{"8003", "Global Returnable Asset Identifier (GRAI)", "N4+N14+X..16", true, "GRAI", 4+14+1, 4+14+16, GS1_STRING},
-		{"8004", "Global Individual Asset Identifier (GIAI)", "N4+X..30", true, "GIAI", 4+1, 4+30, GS1_STRING},
-		{"8005", "Price per unit of measure", "N4+N6", true, "PRICE PER UNIT", 4+6, 0, GS1_STRING},
-		{"8006", "Identification of an individual trade item piece", "N4+N14+N2+N2", true, "ITIP or GCTIN", 4+14+2+2, 0, GS1_STRING},
-		{"8007", "International Bank Account Number (IBAN)", "N4+X..34", true, "IBAN", 4+1, 4+34, GS1_STRING},
-		{"8008", "Date and time of production", "N4+N8+N..4", true, "PROD TIME", 4+8+1, 4+8+4, GS1_STRING},
-		{"8010", "Component / Part Identifier (CPID)", "N4+X..30", true, "CPID", 4+1, 4+30, GS1_STRING},
-		{"8011", "Component / Part Identifier serial number (CPID SERIAL)", "N4+N..12", true, "CPID SERIAL", 4+1, 4+12, GS1_STRING},
-		{"8012", "Software version", "N4+X..20", true, "VERSION", 4+1, 4+20, GS1_STRING},
-		{"8017", 
-			"Global Service Relation Number to identify the relationship between an organisation offering services and the provider of services",
-			"N4+N18", true, "GSRN - PROVIDER", 4+18, 0, GS1_STRING},
-		{"8018", 
-			"Global Service Relation Number to identify the relationship between an organisation offering services and the recipient of services", 
-			"N4+N18", true, "GSRN - RECIPIENT", 4+18, 0, GS1_STRING},
-		{"8019", "Service Relation Instance Number (SRIN)", "N4+N..10", true, "SRIN", 4+1, 4+10, GS1_STRING},
-		{"8020", "Payment slip reference number", "N4+X..25", true, "REF No", 4+1, 4+25, GS1_STRING},
-		{"8110", "Coupon code identification for use in North America", "N4+X..70", true, "-", 4+1, 4+70, GS1_STRING},
-		{"8111", "Loyalty points of a coupon", "N4+N4", true, "POINTS", 4+4, 0, GS1_STRING},
-		{"8112", "Paperless coupon code identification for use in North America (AI 8112)", "N4+X..70", true, "-", 4+1, 4+70, GS1_STRING},
-		{"8200", "Extended Packaging URL", "N4+X..70", true, "PRODUCT URL", 4+1, 4+70, GS1_STRING},
-
-		//90  Information mutually agreed between trading partners	N2+X..30  (FNC1)  INTERNAL
-		{"90", "Information mutually agreed between trading partners", "N2+X..30", true, "INTERNAL", 2+1, 2+30, GS1_STRING},
-
-		//91 to 99  Company internal information  N2+X..90  (FNC1)  INTERNAL
-		{"91", "Company internal information", "N2+X..90", true, "INTERNAL", 2+1, 2+90, GS1_STRING},
-		{"92", "Company internal information", "N2+X..90", true, "INTERNAL", 2+1, 2+90, GS1_STRING},
-		{"93", "Company internal information", "N2+X..90", true, "INTERNAL", 2+1, 2+90, GS1_STRING},
-		{"94", "Company internal information", "N2+X..90", true, "INTERNAL", 2+1, 2+90, GS1_STRING},
-		{"95", "Company internal information", "N2+X..90", true, "INTERNAL", 2+1, 2+90, GS1_STRING},
-		{"96", "Company internal information", "N2+X..90", true, "INTERNAL", 2+1, 2+90, GS1_STRING},
-		{"97", "Company internal information", "N2+X..90", true, "INTERNAL", 2+1, 2+90, GS1_STRING},
-		{"98", "Company internal information", "N2+X..90", true, "INTERNAL", 2+1, 2+90, GS1_STRING},
-		{"99", "Company internal information", "N2+X..90", true, "INTERNAL", 2+1, 2+90, GS1_STRING}
-
-		//NOTES:
-		//- n   implied decimal point position
-		//- N   numeric digit
-		//- X  any character in Figure 7.11-1
-		//- N3  3 numeric digits, predefined length
-		//- N..3  up to 3 numeric digits
-		//- X..3  up to 3 characters in Figure 7.11-1
-	};
-
-
-
-	int compare_ai(const char *ptr_ai, const char *ptr_nums)
-	{
-		while(*ptr_ai && *ptr_nums &&
-			((*ptr_ai == 'n') || (*ptr_ai == *ptr_nums)))
-		{
-			if (*ptr_ai == 'n')
-				return 0; //all prev nums are equal
-			else
-			{
-				ptr_ai++;
-				ptr_nums++;
-			}
-		}
-		if (!*ptr_ai || (*ptr_ai == 'n'))
-			return 0; //end of ai, prev are eq.
-
-		return (*ptr_ai < *ptr_nums) ? -1 : 1;
-	}
-
-	template<class P, class V>
-	const P* bin_find(const P *first, const P *last, const V val, int (*comp)(const V, const V))
-	{
-		for(;;)
-		{
-			int distance = (last - first);
-			const P *step = first + distance/2;
-			int res = comp(*step, val);
-			if (res == 0)
-				return step;
-
-			if (distance < 2)
-			{
-				if (res > 0)
-					return (0 == comp(*first, val)) ? first : 0;
-				else
-					return (0 == comp(*last, val)) ? last : 0;
-			}
-
-			if (res > 0)
-				last = step;
-			else
-				first = step;
-		}
-	}
-
-	const AI * get_ai(const char *gs1_field)
-	{
-		const int count = sizeof(ai_list)/sizeof(AI);
-		const AI *first = ai_list;
-		const AI *last = ai_list + count - 1;
-
-		const AI *ptr = bin_find(first, last, gs1_field, compare_ai);
-		return ptr;
-	}
-}
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-spec.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#ifdef WIN32
+#pragma warning(disable:4996) //about unsafe sprintf
+#endif
+
+namespace GS1
+{
+	const AI ai_list[] = 
+	{
+		// ai,		desc_content,		desc_format,		FNC1_required,		data_title,		field_len,		max_field_len_optional
+
+
+		{"00", "Serial Shipping Container Code (SSCC)",		"N2+N18", false, "SSCC", 2+18, 0, GS1_STRING},
+		{"01", "Global Trade Item Number (GTIN)",			"N2+N14", false, "GTIN", 2+14, 0, GS1_STRING},
+		{"02", "GTIN of contained trade items",				"N2+N14", false, "CONTENT", 2+14, 0, GS1_STRING},
+		
+		{"10", "Batch or lot number",			"N2+X..20", true, "BATCH/LOT", 2+1, 2+20, GS1_STRING},
+		{"11", "Production date (YYMMDD)",		"N2+N6", false, "PROD DATE", 2+6, 0, GS1_DATE},
+		{"12", "Due date (YYMMDD)",				"N2+N6", false, "DUE DATE", 2+6, 0, GS1_DATE},
+		{"13", "Packaging date (YYMMDD)",		"N2+N6", false, "PACK DATE", 2+6, 0, GS1_DATE},
+		{"15", "Best before date (YYMMDD)",		"N2+N6", false, "BEST BEFORE/BEST BY", 2+6, 0, GS1_DATE},
+		{"16", "Sell by date (YYMMDD)",			"N2+N6", false, "SELL BY", 2+6, 0, GS1_DATE},
+		{"17", "Expiration date (YYMMDD)",		"N2+N6", false, "USE BY/EXPIRY", 2+6, 0, GS1_DATE},
+
+		{"20", "Internal product variant", 		"N2+N2", false, "VARIANT", 2+2, 0, GS1_STRING},
+		{"21", "Serial number",					"N2+X..20", true, "SERIAL", 2+1, 2+20, GS1_STRING},
+		{"22", "Consumer product variant",		"N2+X..20", true, "CPV", 2+1, 2+20, GS1_STRING},
+
+		{"240", "Additional item identification",	"N3+X..30", true, "ADDITIONAL ID", 3+1, 3+30, GS1_STRING},
+		{"241", "Customer part number",				"N3+X..30", true, "CUST. PART NO.", 3+1, 3+30, GS1_STRING},
+		{"242", "Made-to-Order variation number",	"N3+N..6", true, "MTO VARIANT", 3+1, 3+6, GS1_STRING},
+		{"243", "Packaging component number",		"N3+X..20", true, "PCN", 3+1, 3+20, GS1_STRING},
+		{"250", "Secondary serial number",			"N3+X..30", true, "SECONDARY SERIAL", 3+1, 3+30, GS1_STRING},
+		{"251", "Reference to source entity",		"N3+X..30", true, "REF. TO SOURCE", 3+1, 3+30, GS1_STRING},
+		{"253", "Global Document Type Identifier (GDTI)",	"N3+N13+X..17", true, "GDTI", 3+13+1, 3+13+17, GS1_STRING},
+		{"254", "GLN extension component",					"N3+X..20", true, "GLN EXTENSION COMPONENT", 3+1, 3+20, GS1_STRING},
+		{"255", "Global Coupon Number (GCN)",				"N3+N13+N..12", true, "GCN", 3+13+1, 3+13+12, GS1_STRING},
+
+		{"30", "Variable count of items (variable measure trade item)",	"N2+N..8", true, "VAR. COUNT", 2+1, 2+8, GS1_STRING},
+
+		//310n Net weight, kilograms (variable measure trade item) N4+N6  (no)  NET WEIGHT (kg)
+		//{"3100", "Net weight, kilograms",	"N4+N6", false, "NET WEIGHT (kg)", 4+6, 0, GS1_STRING}, // 000000. kg
+		//{"3101", "Net weight, kilograms",	"N4+N6", false, "NET WEIGHT (kg)", 4+6, 0, GS1_STRING}, // 00000.0 kg
+	 	//{"3102", "Net weight, kilograms",	"N4+N6", false, "NET WEIGHT (kg)", 4+6, 0, GS1_STRING}, // 0000.00 kg
+		//{"3103", "Net weight, kilograms",	"N4+N6", false, "NET WEIGHT (kg)", 4+6, 0, GS1_STRING}, // 000.000 kg
+		//{"3104", "Net weight, kilograms",	"N4+N6", false, "NET WEIGHT (kg)", 4+6, 0, GS1_STRING}, // 00.0000 kg
+		//{"3105", "Net weight, kilograms",	"N4+N6", false, "NET WEIGHT (kg)", 4+6, 0, GS1_STRING}, // 0.00000 kg
+		//{"3106", "Net weight, kilograms",	"N4+N6", false, "NET WEIGHT (kg)", 4+6, 0, GS1_STRING}, // .000000 kg
+		{"310n", "Net weight, kilograms",	"N4+N6", false, "NET WEIGHT (kg)", 4+6, 0, GS1_DECIMAL},
+
+		//311n	Length or first dimension, metres (variable measure trade item)	N4+N6  (no)  LENGTH (m)
+		{"311n", "Length or first dimension, metres",	"N4+N6", false, "LENGTH (m)", 4+6, 0, GS1_DECIMAL},
+
+		//312n Width, diameter, or second dimension, metres (variable measure trade item)  N4+N6  (no)   WIDTH (m)
+		{"312n", "Width, diameter, or second dimension, metres", "N4+N6", false, "WIDTH (m)", 4+6, 0, GS1_DECIMAL},
+
+		//313n	Depth, thickness, height, or third dimension, metres (variable measure trade item)	N4+N6  (no)  HEIGHT (m)
+		{"313n", "Depth, thickness, height, or third dimension, metres", "N4+N6", false, "HEIGHT (m)", 4+6, 0, GS1_DECIMAL},
+
+		//314n	Area, square metres (variable measure trade item)	N4+N6    AREA (m2)
+		{"314n", "Area, square metres", "N4+N6", false, "AREA (m2)", 4+6, 0, GS1_DECIMAL},
+		
+		//315n	Net volume, litres (variable measure trade item)  N4+N6    NET VOLUME (l)
+		{"315n", "Net volume, litres", "N4+N6", false, "NET VOLUME (l)", 4+6, 0, GS1_DECIMAL},
+
+		//316n	Net volume, cubic metres (variable measure trade item)	N4+N6    NET VOLUME (m3)
+		{"316n", "Net volume, cubic metres", "N4+N6", false, "NET VOLUME (m3)", 4+6, 0, GS1_DECIMAL},
+		
+		//320n	Net weight, pounds (variable measure trade item)  N4+N6		NET WEIGHT (lb)
+		{"320n", "Net weight, pounds", "N4+N6", false, "NET WEIGHT (lb)", 4+6, 0, GS1_DECIMAL},
+		
+		//321n	Length or first dimension, inches (variable measure trade item)	N4+N6 LENGTH (i)
+		{"321n", "Length or first dimension, inches", "N4+N6", false, "LENGTH (i)", 4+6, 0, GS1_DECIMAL},
+
+		//322n	Length or first dimension, feet (variable measure trade item)	N4+N6	LENGTH (f) 
+		{"322n", "Length or first dimension, feet", "N4+N6", false, "LENGTH (f)", 4+6, 0, GS1_DECIMAL},
+		
+		//323n	Length or first dimension, yards (variable measure trade item)	N4+N6 LENGTH (y)
+		{"323n", "Length or first dimension, yards", "N4+N6", false, "LENGTH (y)", 4+6, 0, GS1_DECIMAL},
+		
+		//324n	Width, diameter, or second dimension, inches (variable measure trade item)	N4+N6 WIDTH (i)
+		{"324n", "Width, diameter, or second dimension, inches", "N4+N6", false, "WIDTH (i)", 4+6, 0, GS1_DECIMAL},
+
+		//325n	Width, diameter, or second dimension, feet (variable measure trade item)	N4+N6	WIDTH (f)
+		{"325n", "Width, diameter, or second dimension, feet", "N4+N6", false, "WIDTH (f)", 4+6, 0, GS1_DECIMAL},
+		
+		//326n	Width, diameter, or second dimension, yards (variable measure trade item)	N4+N6 WIDTH (y)
+		{"326n", "Width, diameter, or second dimension, yards", "N4+N6", false, "WIDTH (y)", 4+6, 0, GS1_DECIMAL},
+		
+		//327n	Depth, thickness, height, or third dimension, inches (variable measure trade item)	N4+N6 HEIGHT (i)
+		{"327n", "Depth, thickness, height, or third dimension, inches", "N4+N6", false, "HEIGHT (i)", 4+6, 0, GS1_DECIMAL},
+		
+		//328n	Depth, thickness, height, or third dimension, feet (variable measure trade item)	N4+N6 HEIGHT (f)
+		{"328n", "Depth, thickness, height, or third dimension, feet", "N4+N6", false, "HEIGHT (f)", 4+6, 0, GS1_DECIMAL},
+		
+		//329n	Depth, thickness, height, or third dimension, yards (variable measure trade item)	N4+N6	HEIGHT (y)
+		{"329n", "Depth, thickness, height, or third dimension, yards", "N4+N6", false, "HEIGHT (y)", 4+6, 0, GS1_DECIMAL},
+		
+		//330n	Logistic weight, kilograms  N4+N6    GROSS WEIGHT (kg)
+		{"330n", "Logistic weight, kilograms", "N4+N6", false, "GROSS WEIGHT (kg)", 4+6, 0, GS1_DECIMAL},
+		
+		//331n	Length or first dimension, metres  N4+N6    LENGTH (m), log
+		{"331n", "Length or first dimension, metres", "N4+N6", false, "LENGTH (m), log", 4+6, 0, GS1_DECIMAL},
+
+		//332n	Width, diameter, or second dimension, metres  N4+N6    WIDTH (m), log
+		{"332n", "Width, diameter, or second dimension, metres", "N4+N6", false, "WIDTH (m), log", 4+6, 0, GS1_DECIMAL},
+
+		//333n	Depth, thickness, height, or third dimension, metres	N4+N6    HEIGHT (m), log
+		{"333n", "Depth, thickness, height, or third dimension, metres", "N4+N6", false, "HEIGHT (m), log", 4+6, 0, GS1_DECIMAL},
+		
+		//334n	Area, square metres  N4+N6    AREA (m2), log
+		{"334n", "Area, square metres", "N4+N6", false, "AREA (m2), log", 4+6, 0, GS1_DECIMAL},
+		
+		//335n	Logistic volume, litres  N4+N6    VOLUME (l), log
+		{"335n", "Logistic volume, litres", "N4+N6", false, "VOLUME (l), log", 4+6, 0, GS1_DECIMAL},
+		
+		//336n	Logistic volume, cubic metres  N4+N6    VOLUME (m3), log
+		{"336n", "Logistic volume, cubic metres", "N4+N6", false, "VOLUME (m3), log", 4+6, 0, GS1_DECIMAL},
+		
+		//337n	Kilograms per square metre  N4+N6    KG PER m2
+		{"337n", "Kilograms per square metre", "N4+N6", false, "KG PER m2", 4+6, 0, GS1_DECIMAL},
+		
+		//340n	Logistic weight, pounds  N4+N6    GROSS WEIGHT (lb)
+		{"340n", "Logistic weight, pounds", "N4+N6", false, "GROSS WEIGHT (lb)", 4+6, 0, GS1_DECIMAL},
+		
+		//341n	Length or first dimension, inches  N4+N6    LENGTH (i), log
+		{"341n", "Length or first dimension, inches", "N4+N6", false, "LENGTH (i), log", 4+6, 0, GS1_DECIMAL},
+		
+		//342n	Length or first dimension, feet  N4+N6    LENGTH (f), log
+		{"342n", "Length or first dimension, feet", "N4+N6", false, "LENGTH (f), log", 4+6, 0, GS1_DECIMAL},
+		
+		//343n	Length or first dimension, yards  N4+N6    LENGTH (y), log
+		{"343n", "Length or first dimension, yards", "N4+N6", false, "LENGTH (y), log", 4+6, 0, GS1_DECIMAL},
+		
+		//344n	Width, diameter, or second dimension, inches  N4+N6    WIDTH (i), log
+		{"344n", "Width, diameter, or second dimension, inches", "N4+N6", false, "WIDTH (i), log", 4+6, 0, GS1_DECIMAL},
+		
+		//345n	Width, diameter, or second dimension, feet  N4+N6    WIDTH (f), log
+		{"345n", "Width, diameter, or second dimension, feet", "N4+N6", false, "WIDTH (f), log", 4+6, 0, GS1_DECIMAL},
+		
+		//346n	Width, diameter, or second dimension, yard  N4+N6    WIDTH (y), log
+		{"346n", "Width, diameter, or second dimension, yard", "N4+N6", false, "WIDTH (y), log", 4+6, 0, GS1_DECIMAL},
+		
+		//347n	Depth, thickness, height, or third dimension, inches	N4+N6    HEIGHT (i), log
+		{"347n", "Depth, thickness, height, or third dimension, inches", "N4+N6", false, "HEIGHT (i), log", 4+6, 0, GS1_DECIMAL},
+
+		//348n	Depth, thickness, height, or third dimension, feet  N4+N6    HEIGHT (f), log
+		{"348n", "Depth, thickness, height, or third dimension, feet", "N4+N6", false, "HEIGHT (f), log", 4+6, 0, GS1_DECIMAL},
+		
+		//349n	Depth, thickness, height, or third dimension, yards		N4+N6    HEIGHT (y), log
+		{"349n", "Depth, thickness, height, or third dimension, yards", "N4+N6", false, "HEIGHT (y), log", 4+6, 0, GS1_DECIMAL},
+		
+		//350n	Area, square inches (variable measure trade item)	N4+N6    AREA (i2)
+		{"350n", "Area, square inches", "N4+N6", false, "AREA (i2)", 4+6, 0, GS1_DECIMAL},
+		
+		//351n	Area, square feet (variable measure trade item)  N4+N6    AREA (f2)
+		{"351n", "Area, square feet", "N4+N6", false, "AREA (f2)", 4+6, 0, GS1_DECIMAL},
+		
+		//352n	Area, square yards (variable measure trade item)  N4+N6    AREA (y2)
+		{"352n", "Area, square yards", "N4+N6", false, "AREA (y2)", 4+6, 0, GS1_DECIMAL},
+		
+		//353n	Area, square inches  N4+N6 AREA (i2), log
+		{"353n", "Area, square inches", "N4+N6", false, "AREA (i2), log", 4+6, 0, GS1_DECIMAL},
+		
+		//354n	Area, square feet  N4+N6    AREA (f2), log
+		{"354n", "Area, square feet", "N4+N6", false, "AREA (f2), log", 4+6, 0, GS1_DECIMAL},
+		
+		//355n	Area, square yards  N4+N6    AREA (y2), log
+		{"355n", "Area, square yards", "N4+N6", false, "AREA (y2), log", 4+6, 0, GS1_DECIMAL},
+		
+		//356n	Net weight, troy ounces (variable measure trade item)	N4+N6    NET WEIGHT (t)
+		{"356n", "Net weight, troy ounces", "N4+N6", false, "NET WEIGHT (t)", 4+6, 0, GS1_DECIMAL},
+		
+		//357n	Net weight (or volume), ounces (variable measure trade item)	N4+N6    NET VOLUME (oz)
+		{"357n", "Net weight (or volume), ounces", "N4+N6", false, "NET VOLUME (oz)", 4+6, 0, GS1_DECIMAL},
+		
+		//360n	Net volume, quarts (variable measure trade item)  N4+N6    NET VOLUME (q)
+		{"360n", "Net volume, quarts", "N4+N6", false, "NET VOLUME (q)", 4+6, 0, GS1_DECIMAL},
+		
+		//361n	Net volume, gallons U.S. (variable measure trade item)	N4+N6    NET VOLUME (g)
+		{"361n", "Net volume, gallons U.S.", "N4+N6", false, "NET VOLUME (g)", 4+6, 0, GS1_DECIMAL},
+		
+		//362n	Logistic volume, quarts  N4+N6    VOLUME (q), log
+		{"362n", "Logistic volume, quarts", "N4+N6", false, "VOLUME (q), log", 4+6, 0, GS1_DECIMAL},
+		
+		//363n	Logistic volume, gallons U.S.  N4+N6    VOLUME (g), log
+		{"363n", "Logistic volume, gallons U.S.", "N4+N6", false, "VOLUME (g), log", 4+6, 0, GS1_DECIMAL},
+		
+		//364n	Net volume, cubic inches (variable measure trade item)	N4+N6    VOLUME (i3)
+		{"364n", "Net volume, cubic inches", "N4+N6", false, "VOLUME (i3)", 4+6, 0, GS1_DECIMAL},
+		
+		//365n	Net volume, cubic feet (variable measure trade item)	N4+N6    VOLUME (f3)
+		{"365n", "Net volume, cubic feet", "N4+N6", false, "VOLUME (f3)", 4+6, 0, GS1_DECIMAL},
+		
+		//366n	Net volume, cubic yards (variable measure trade item)	N4+N6    VOLUME (y3)
+		{"366n", "Net volume, cubic yards", "N4+N6", false, "VOLUME (y3)", 4+6, 0, GS1_DECIMAL},
+		
+		//367n	Logistic volume, cubic inches  N4+N6    VOLUME (i3), log
+		{"367n", "Logistic volume, cubic inches", "N4+N6", false, "VOLUME (i3), log", 4+6, 0, GS1_DECIMAL},
+		
+		//368n	Logistic volume, cubic feet  N4+N6    VOLUME (f3), log
+		{"368n", "Logistic volume, cubic feet", "N4+N6", false, "VOLUME (f3), log", 4+6, 0, GS1_DECIMAL},
+		
+		//369n	Logistic volume, cubic yards  N4+N6    VOLUME (y3), log
+		{"369n", "Logistic volume, cubic yards", "N4+N6", false, "VOLUME (y3), log", 4+6, 0, GS1_DECIMAL},
+
+		{"37", "Count of trade items", "N2+N..8", true, "COUNT", 2+1, 2+8, GS1_STRING},
+
+		//390n	Applicable amount payable or Coupon value, local currency	N4+N..15	(FNC1)  AMOUNT
+		{"390n", "Applicable amount payable or Coupon value, local currency", "N4+N..15", true, "AMOUNT", 4+1, 4+15, GS1_DECIMAL},
+
+		//391n	Applicable amount payable with ISO currency code	N4+N3+N..15	(FNC1)  AMOUNT
+		{"391n", "Applicable amount payable with ISO currency code", "N4+N3+N..15", true, "AMOUNT", 4+3+1, 4+3+15, GS1_DECIMAL},
+
+		//392n	Applicable amount payable, single monetary area (variable measure trade item)	N4+N..15	(FNC1)  PRICE
+		{"392n", "Applicable amount payable, single monetary area", "N4+N..15", true, "PRICE", 4+1, 4+15, GS1_DECIMAL},
+		
+		//393n	Applicable amount payable with ISO currency code (variable measure trade item)	N4+N3+N..15	(FNC1)  PRICE
+		{"393n", "Applicable amount payable with ISO currency code", "N4+N3+N..15", true, "PRICE", 4+3+1, 4+3+15, GS1_DECIMAL},
+		
+		//394n	Percentage discount of a coupon  N4+N4  (FNC1)  PRCNT OFF
+		{"394n", "Percentage discount of a coupon", "N4+N4", true, "PRCNT OFF", 4+4, 0, GS1_DECIMAL},
+		
+		{"400", "Customer's purchase order number", "N3+X..30", true, "ORDER NUMBER", 3+1, 3+30, GS1_STRING},
+		{"401", "Global Identification Number for Consignment (GINC)", "N3+X..30", true, "GINC", 3+1, 3+30, GS1_STRING},
+		{"402", "Global Shipment Identification Number (GSIN)", "N3+N17", true, "GSIN", 3+17, 0, GS1_STRING},
+		{"403", "Routing code", "N3+X..30", true, "ROUTE", 3+1, 3+30, GS1_STRING},
+
+		{"410", "Ship to - Deliver to Global Location Number", "N3+N13", false, "SHIP TO LOC", 3+13, 0, GS1_STRING},
+		{"411", "Bill to - Invoice to Global Location Number", "N3+N13", false, "BILL TO", 3+13, 0, GS1_STRING},
+		{"412", "Purchased from Global Location Number", "N3+N13", false, "PURCHASE FROM", 3+13, 0, GS1_STRING},
+		{"413", "Ship for - Deliver for - Forward to Global Location Number", "N3+N13", false, "SHIP FOR LOC", 3+13, 0, GS1_STRING},
+		{"414", "Identification of a physical location - Global Location Number", "N3+N13", false, "LOC No", 3+13, 0, GS1_STRING},
+		{"415", "Global Location Number of the invoicing party", "N3+N13", false, "PAY TO", 3+13, 0, GS1_STRING},
+		{"416", "GLN of the production or service location", "N3+N13", false, "PROD/SERV LOC", 3+13, 0, GS1_STRING},
+
+
+		{"420", "Ship to - Deliver to postal code within a single postal authority", "N3+X..20", true, "SHIP TO POST", 3+1, 3+20, GS1_STRING},
+		{"421", "Ship to - Deliver to postal code with ISO country code", "N3+N3+X..9", true, "SHIP TO POST", 3+3+1, 3+3+9, GS1_STRING},
+		{"422", "Country of origin of a trade item", "N3+N3", true, "ORIGIN", 3+3, 0, GS1_STRING},
+		{"423", "Country of initial processing", "N3+N3+N..12", true, "COUNTRY - INITIAL PROCESS", 3+3+1, 3+3+12, GS1_STRING},
+		{"424", "Country of processing", "N3+N3", true, "COUNTRY - PROCESS", 3+3, 0, GS1_STRING},
+		{"425", "Country of disassembly", "N3+N3+N..12", true, "COUNTRY - DISASSEMBLY", 3+3+1, 3+3+12, GS1_STRING},
+		{"426", "Country covering full process chain", "N3+N3", true, "COUNTRY  FULL PROCESS", 3+3, 0, GS1_STRING},
+		{"427", "Country subdivision Of origin", "N3+X..3", true, "ORIGIN SUBDIVISION", 3+1, 3+3, GS1_STRING},
+
+		{"7001", "NATO Stock Number (NSN)", "N4+N13", true, "NSN", 4+13, 0, GS1_STRING},
+		{"7002", "UN/ECE meat carcasses and cuts classification", "N4+X..30", true, "MEAT CUT", 4+1, 4+30, GS1_STRING},
+		{"7003", "Expiration date and time", "N4+N10", true, "EXPIRY TIME", 4+10, 0, GS1_STRING},
+		{"7004", "Active potency", "N4+N..4", true, "ACTIVE POTENCY", 4+1, 4+4, GS1_STRING},
+		{"7005", "Catch area", "N4+X..12", true, "CATCH AREA", 4+1, 4+12, GS1_STRING},
+		{"7006", "First freeze date", "N4+N6", true, "FIRST FREEZE DATE", 4+6, 0, GS1_STRING},
+		{"7007", "Harvest date", "N4+N6..12", true, "HARVEST DATE", 4+6, 4+12, GS1_STRING},
+		{"7008", "Species for fishery purposes", "N4+X..3", true, "AQUATIC SPECIES", 4+1, 4+3, GS1_STRING},
+		{"7009", "Fishing gear type", "N4+X..10", true, "FISHING GEAR TYPE", 4+1, 4+10, GS1_STRING},
+		{"7010", "Production method", "N4+X..2", true, "PROD METHOD", 4+1, 4+2, GS1_STRING},
+		{"7020", "Refurbishment lot ID", "N4+X..20", true, "REFURB LOT", 4+1, 4+20, GS1_STRING},
+		{"7021", "Functional status", "N4+X..20", true, "FUNC STAT", 4+1, 4+20, GS1_STRING},
+		{"7022", "Revision status", "N4+X..20", true, "REV STAT", 4+1, 4+20, GS1_STRING},
+		{"7023", "Global Individual Asset Identifier (GIAI) of an assembly", "N4+X..30", true, "GIAI  ASSEMBLY", 4+1, 4+30, GS1_STRING},
+
+		//703s  Number of processor with ISO Country Code  N4+N3+X..27  (FNC1)  PROCESSOR # s
+		//UNSUPPORTED yet
+
+		{"710", "National Healthcare Reimbursement Number (NHRN)  Germany PZN", "N3+X..20", true, "NHRN PZN", 3+1, 3+20, GS1_STRING},
+		{"711", "National Healthcare Reimbursement Number (NHRN)  France CIP", "N3+X..20", true, "NHRN CIP", 3+1, 3+20, GS1_STRING},
+		{"712", "National Healthcare Reimbursement Number (NHRN)  Spain CN", "N3+X..20", true, "NHRN CN", 3+1, 3+20, GS1_STRING},
+		{"713", "National Healthcare Reimbursement Number (NHRN)  Brasil DRN", "N3+X..20", true, "NHRN DRN", 3+1, 3+20, GS1_STRING},
+
+		{"8001", "Roll products (width, length, core diameter, direction, splices)", "N4+N14", true, "DIMENSIONS", 4+14, 0, GS1_STRING},
+		{"8002", "Cellular mobile telephone identifier", "N4+X..20", true, "CMT No", 4+1, 4+20, GS1_STRING},
+		{"8003", "Global Returnable Asset Identifier (GRAI)", "N4+N14+X..16", true, "GRAI", 4+14+1, 4+14+16, GS1_STRING},
+		{"8004", "Global Individual Asset Identifier (GIAI)", "N4+X..30", true, "GIAI", 4+1, 4+30, GS1_STRING},
+		{"8005", "Price per unit of measure", "N4+N6", true, "PRICE PER UNIT", 4+6, 0, GS1_STRING},
+		{"8006", "Identification of an individual trade item piece", "N4+N14+N2+N2", true, "ITIP or GCTIN", 4+14+2+2, 0, GS1_STRING},
+		{"8007", "International Bank Account Number (IBAN)", "N4+X..34", true, "IBAN", 4+1, 4+34, GS1_STRING},
+		{"8008", "Date and time of production", "N4+N8+N..4", true, "PROD TIME", 4+8+1, 4+8+4, GS1_STRING},
+		{"8010", "Component / Part Identifier (CPID)", "N4+X..30", true, "CPID", 4+1, 4+30, GS1_STRING},
+		{"8011", "Component / Part Identifier serial number (CPID SERIAL)", "N4+N..12", true, "CPID SERIAL", 4+1, 4+12, GS1_STRING},
+		{"8012", "Software version", "N4+X..20", true, "VERSION", 4+1, 4+20, GS1_STRING},
+		{"8017", 
+			"Global Service Relation Number to identify the relationship between an organisation offering services and the provider of services",
+			"N4+N18", true, "GSRN - PROVIDER", 4+18, 0, GS1_STRING},
+		{"8018", 
+			"Global Service Relation Number to identify the relationship between an organisation offering services and the recipient of services", 
+			"N4+N18", true, "GSRN - RECIPIENT", 4+18, 0, GS1_STRING},
+		{"8019", "Service Relation Instance Number (SRIN)", "N4+N..10", true, "SRIN", 4+1, 4+10, GS1_STRING},
+		{"8020", "Payment slip reference number", "N4+X..25", true, "REF No", 4+1, 4+25, GS1_STRING},
+		{"8110", "Coupon code identification for use in North America", "N4+X..70", true, "-", 4+1, 4+70, GS1_STRING},
+		{"8111", "Loyalty points of a coupon", "N4+N4", true, "POINTS", 4+4, 0, GS1_STRING},
+		{"8112", "Paperless coupon code identification for use in North America (AI 8112)", "N4+X..70", true, "-", 4+1, 4+70, GS1_STRING},
+		{"8200", "Extended Packaging URL", "N4+X..70", true, "PRODUCT URL", 4+1, 4+70, GS1_STRING},
+
+		//90  Information mutually agreed between trading partners	N2+X..30  (FNC1)  INTERNAL
+		{"90", "Information mutually agreed between trading partners", "N2+X..30", true, "INTERNAL", 2+1, 2+30, GS1_STRING},
+
+		//91 to 99  Company internal information  N2+X..90  (FNC1)  INTERNAL
+		{"91", "Company internal information", "N2+X..90", true, "INTERNAL", 2+1, 2+90, GS1_STRING},
+		{"92", "Company internal information", "N2+X..90", true, "INTERNAL", 2+1, 2+90, GS1_STRING},
+		{"93", "Company internal information", "N2+X..90", true, "INTERNAL", 2+1, 2+90, GS1_STRING},
+		{"94", "Company internal information", "N2+X..90", true, "INTERNAL", 2+1, 2+90, GS1_STRING},
+		{"95", "Company internal information", "N2+X..90", true, "INTERNAL", 2+1, 2+90, GS1_STRING},
+		{"96", "Company internal information", "N2+X..90", true, "INTERNAL", 2+1, 2+90, GS1_STRING},
+		{"97", "Company internal information", "N2+X..90", true, "INTERNAL", 2+1, 2+90, GS1_STRING},
+		{"98", "Company internal information", "N2+X..90", true, "INTERNAL", 2+1, 2+90, GS1_STRING},
+		{"99", "Company internal information", "N2+X..90", true, "INTERNAL", 2+1, 2+90, GS1_STRING}
+
+		//NOTES:
+		//- n   implied decimal point position
+		//- N   numeric digit
+		//- X  any character in Figure 7.11-1
+		//- N3  3 numeric digits, predefined length
+		//- N..3  up to 3 numeric digits
+		//- X..3  up to 3 characters in Figure 7.11-1
+	};
+
+
+	const int ai_count = sizeof(ai_list)/sizeof(AI);
+
+	//AI dispatch index, built once from ai_list
+	//	root: 100 nodes selected by the first two digits
+	//	sub-table: 10 nodes selected by the next digit
+	//	node: 0 - unknown AI, >0 - leaf (ai_list index + 1), <0 - sub-table -(number + 1)
+	//'n' closes the AI code: the leaf is put at the node of the last digit before 'n'
+	class IndexAI
+	{
+	public:
+		enum { ROOT_SIZE = 100, MAX_SUB_TABLES = 255 };
+
+		IndexAI() { clear(); }
+
+		void clear();
+		bool build(const AI *list, int count, int *failed_id = 0);
+
+		//at most 4 digit loads, no string comparisons; -1 if unknown
+		inline int find(const char *gs1_field, int len) const
+		{
+			if (len < 2)
+				return -1;
+
+			unsigned int d0 = (unsigned char)gs1_field[0] - '0';
+			if (d0 > 9)
+				return -1;
+			unsigned int d1 = (unsigned char)gs1_field[1] - '0';
+			if (d1 > 9)
+				return -1;
+
+			int node = nodes[d0*10 + d1];
+			for(int i=2; node < 0; i++)
+			{
+				if (i >= len)
+					return -1;
+				unsigned int d = (unsigned char)gs1_field[i] - '0';
+				if (d > 9)
+					return -1;
+				node = nodes[ROOT_SIZE + 10*(-node - 1) + d];
+			}
+			return node - 1;
+		}
+
+	protected:
+		short nodes[ROOT_SIZE + 10*MAX_SUB_TABLES];
+		int sub_count;
+	};
+
+	void IndexAI::clear()
+	{
+		for(int i=0; i<(int)(sizeof(nodes)/sizeof(nodes[0])); i++)
+			nodes[i] = 0;
+		sub_count = 0;
+	}
+
+	bool IndexAI::build(const AI *list, int count, int *failed_id)
+	{
+		clear();
+
+		for(int id=0; id<count; id++)
+		{
+			if (failed_id)
+				*failed_id = id;
+
+			const char *code = list[id].ai;
+			if (!code)
+				return false;
+
+			//digits before wildcard
+			int digits = 0;
+			while(code[digits] >= '0' && code[digits] <= '9')
+				digits++;
+			if ((digits < 2) || (digits > 4) ||
+				(code[digits] && (code[digits] != 'n' || code[digits+1])))
+				return false; //unsupported AI code
+			if (digits + (code[digits] ? 1 : 0) > 4)
+				return false; //parsers keep at most 4 code chars
+
+			short *node = &nodes[(code[0]-'0')*10 + (code[1]-'0')];
+			for(int i=2; i<digits; i++)
+			{
+				if (*node > 0)
+					return false; //shorter AI is a prefix of this one
+
+				if (*node == 0)
+				{
+					if (sub_count >= MAX_SUB_TABLES)
+						return false; //too many groups
+					*node = (short)-(++sub_count);
+				}
+
+				node = &nodes[ROOT_SIZE + 10*(-*node - 1) + (code[i]-'0')];
+			}
+
+			if (*node != 0)
+				return false; //duplicate AI or this AI is a prefix of another one
+
+			*node = (short)(id + 1);
+		}
+
+		return true;
+	}
+
+	//entries, their packed parse data and the dispatch index
+	class SpecTableAI
+	{
+	public:
+		const AI *list;
+		const HotAI *hot;
+		int count;
+		IndexAI index;
+	};
+
+	static void build_hot(const AI *list, int count, HotAI *hot)
+	{
+		for(int id=0; id<count; id++)
+		{
+			const AI &ai = list[id];
+			int ai_len = (int)strlen(ai.ai);
+			int body_min = ai.field_len - ai_len;
+			int body_max = (ai.max_field_len_optional > 0) ? ai.max_field_len_optional - ai_len : body_min;
+
+			HotAI &h = hot[id];
+			h.flags = ai.FNC1_required ? HOT_FNC1_REQUIRED : 0;
+			if (body_min <= 0)
+				h.flags |= HOT_INVALID_LEN;
+			else if ((ai.max_field_len_optional > 0) && (body_max <= body_min))
+				h.flags |= HOT_INVALID_MAX_LEN;
+
+			h.ai_len = (unsigned char)ai_len;
+			h.body_min = (unsigned char)((body_min > 0) ? body_min : 0);
+			h.body_max = (unsigned char)((body_max > 0) ? body_max : 0);
+			h.data_format = (unsigned char)ai.data_format;
+			h.reserved = 0;
+			h.id = (unsigned short)id;
+		}
+	}
+
+	class DefaultSpecAI : public SpecTableAI
+	{
+	public:
+		DefaultSpecAI()
+		{
+			build_hot(ai_list, ai_count, hot_list);
+			list = ai_list;
+			hot = hot_list;
+			count = ai_count;
+			index.build(ai_list, ai_count);
+		}
+
+	private:
+		HotAI hot_list[ai_count];
+	};
+
+	//dictionary loaded by load_spec(), strings of entries point into text
+	class LoadedSpecAI : public SpecTableAI
+	{
+	public:
+		std::vector<AI> entries;
+		std::vector<HotAI> hot_list;
+		std::vector<char> text;
+	};
+
+	static const SpecTableAI& default_spec()
+	{
+		static const DefaultSpecAI spec;
+		return spec;
+	}
+
+	//replaced specs are never freed, so AI pointers stay valid
+	static const SpecTableAI *active_spec = &default_spec();
+	static unsigned int spec_version = 0;
+
+	static inline const SpecTableAI& current_spec()
+	{
+		const SpecTableAI *spec = active_spec;
+		return spec ? *spec : default_spec(); //null only during static initialization
+	}
+
+	const AI * get_ai(const char *gs1_field)
+	{
+		//NUL is not a digit, so the lookup never reads past the terminator
+		const SpecTableAI &spec = current_spec();
+		int id = spec.index.find(gs1_field, 4);
+		return (id < 0) ? 0 : &spec.list[id];
+	}
+
+	const AI * get_ai(const char *gs1_field, int len)
+	{
+		const SpecTableAI &spec = current_spec();
+		int id = spec.index.find(gs1_field, len);
+		return (id < 0) ? 0 : &spec.list[id];
+	}
+
+	const AI * get_ai(const char *gs1_field, int len, const HotAI *&hot)
+	{
+		const SpecTableAI &spec = current_spec();
+		int id = spec.index.find(gs1_field, len);
+		if (id < 0)
+			return 0;
+		hot = &spec.hot[id];
+		return &spec.list[id];
+	}
+
+	const AI * get_ai_exact(const char *ai_code, int len, const HotAI *&hot)
+	{
+		const AI *ai = get_ai(ai_code, len, hot);
+		if (!ai || (hot->ai_len != len))
+			return 0;
+		for(int i=0; i<len; i++)
+		{
+			if ((unsigned char)(ai_code[i] - '0') > 9)
+				return 0; //decimal point position must be a digit
+		}
+		return ai;
+	}
+
+	const AI * get_ai_exact(const char *ai_code, int len)
+	{
+		const HotAI *hot;
+		return get_ai_exact(ai_code, len, hot);
+	}
+
+	int get_ai_count()
+	{
+		return current_spec().count;
+	}
+
+	int get_ai_id(const AI *ai)
+	{
+		const SpecTableAI &spec = current_spec();
+		if ((ai < spec.list) || (ai >= spec.list + spec.count))
+			return -1;
+		return (int)(ai - spec.list);
+	}
+
+	const AI * get_ai_by_id(int id)
+	{
+		const SpecTableAI &spec = current_spec();
+		if ((id < 0) || (id >= spec.count))
+			return 0;
+		return &spec.list[id];
+	}
+
+	const HotAI * get_ai_hot(int id)
+	{
+		const SpecTableAI &spec = current_spec();
+		if ((id < 0) || (id >= spec.count))
+			return 0;
+		return &spec.hot[id];
+	}
+
+	int find_ai_id(const char *ai)
+	{
+		if (!ai)
+			return -1;
+
+		const SpecTableAI &spec = current_spec();
+		int id = spec.index.find(ai, 4);
+		if ((id < 0) || strcmp(spec.list[id].ai, ai))
+			return -1; //not a whole AI group code
+		return id;
+	}
+
+	static const char *const data_format_names[] = {"string", "date", "decimal"};
+
+	static bool parse_count(const char *text, int &value)
+	{
+		value = 0;
+		if (!*text)
+			return false;
+		for(; *text; text++)
+		{
+			if ((*text < '0') || (*text > '9') || (value > 9999))
+				return false;
+			value = value * 10 + (*text - '0');
+		}
+		return true;
+	}
+
+	//one dictionary line split at tabs, false if it is not a valid entry
+	static bool parse_entry(char *line, AI &ai)
+	{
+		const int COLUMNS = 8;
+		char *columns[COLUMNS];
+		int n = 0;
+		for(char *c = line; ; )
+		{
+			columns[n++] = c;
+			char *tab = (n < COLUMNS) ? strchr(c, '\t') : 0; //the description may contain tabs
+			if (!tab)
+				break;
+			*tab = 0;
+			c = tab + 1;
+		}
+		if (n < 6)
+			return false;
+
+		ai.ai = columns[0];
+		ai.desc_format = columns[5];
+		ai.data_title = (n > 6) ? columns[6] : "";
+		ai.desc_content = (n > 7) ? columns[7] : "";
+
+		if (!parse_count(columns[1], ai.field_len) || !parse_count(columns[2], ai.max_field_len_optional))
+			return false;
+
+		if (!strcmp(columns[3], "0") || !strcmp(columns[3], "1"))
+			ai.FNC1_required = (columns[3][0] == '1');
+		else
+			return false;
+
+		ai.data_format = -1;
+		for(int i=0; i<(int)(sizeof(data_format_names)/sizeof(data_format_names[0])); i++)
+		{
+			if (!strcmp(columns[4], data_format_names[i]))
+				ai.data_format = i;
+		}
+		if (ai.data_format < 0)
+			return false;
+
+		//same length rules as parse_gs1_field
+		int ai_len = (int)strlen(ai.ai);
+		if ((ai_len < 2) || (ai_len > 4))
+			return false; //digits and wildcard, e.g. "01", "310n", "8003"
+		if (ai.field_len <= ai_len)
+			return false;
+		if ((ai.max_field_len_optional > 0) && (ai.max_field_len_optional <= ai.field_len))
+			return false;
+		if (((ai.max_field_len_optional > 0) ? ai.max_field_len_optional : ai.field_len) - ai_len > 255)
+			return false; //HotAI body lengths are bytes
+		return true;
+	}
+
+	bool load_spec(const char *dictionary, int len, int &error_line)
+	{
+		error_line = 0;
+
+		LoadedSpecAI *spec = new LoadedSpecAI();
+		spec->text.assign(dictionary, dictionary + len);
+		spec->text.push_back(0);
+
+		std::vector<int> lines;
+		char *ptr = &spec->text[0];
+		char *end = ptr + len;
+		for(int line = 1; ptr < end; line++)
+		{
+			char *eol = (char*)memchr(ptr, '\n', end - ptr);
+			if (!eol)
+				eol = end;
+			*eol = 0;
+			if ((eol > ptr) && (eol[-1] == '\r'))
+				eol[-1] = 0;
+
+			if (*ptr && (*ptr != '#'))
+			{
+				AI ai;
+				if (!parse_entry(ptr, ai) || (spec->entries.size() >= 30000))
+				{
+					error_line = line;
+					delete spec;
+					return false;
+				}
+				spec->entries.push_back(ai);
+				lines.push_back(line);
+			}
+			ptr = eol + 1;
+		}
+
+		int failed_id = 0;
+		if (spec->entries.empty() || !spec->index.build(&spec->entries[0], (int)spec->entries.size(), &failed_id))
+		{
+			error_line = spec->entries.empty() ? 0 : lines[failed_id];
+			delete spec;
+			return false;
+		}
+
+		spec->hot_list.resize(spec->entries.size());
+		build_hot(&spec->entries[0], (int)spec->entries.size(), &spec->hot_list[0]);
+		spec->list = &spec->entries[0];
+		spec->hot = &spec->hot_list[0];
+		spec->count = (int)spec->entries.size();
+		active_spec = spec;
+		spec_version++;
+		return true;
+	}
+
+	bool load_spec_file(const char *path, int &error_line)
+	{
+		error_line = 0;
+
+		FILE *f = fopen(path, "rb");
+		if (!f)
+			return false;
+
+		std::vector<char> text;
+		char buf[4096];
+		size_t n;
+		while((n = fread(buf, 1, sizeof(buf), f)) > 0)
+			text.insert(text.end(), buf, buf + n);
+		fclose(f);
+
+		return load_spec(text.empty() ? "" : &text[0], (int)text.size(), error_line);
+	}
+
+	void reset_spec()
+	{
+		active_spec = &default_spec();
+		spec_version++;
+	}
+
+	unsigned int get_spec_version()
+	{
+		return spec_version;
+	}
+
+	void format_spec(std::string &out)
+	{
+		out += "#ai\tfield_len\tmax_len\tFNC1\tformat\tdesc_format\ttitle\tdescription\n";
+
+		const SpecTableAI &spec = current_spec();
+		for(int id=0; id<spec.count; id++)
+		{
+			const AI &ai = spec.list[id];
+			char buf[64];
+			sprintf(buf, "\t%d\t%d\t%d\t", ai.field_len, ai.max_field_len_optional, ai.FNC1_required ? 1 : 0);
+
+			out += ai.ai;
+			out += buf;
+			out += ((ai.data_format >= 0) && (ai.data_format <= GS1_DECIMAL)) ? data_format_names[ai.data_format] : "string";
+			out += '\t';
+			out += ai.desc_format ? ai.desc_format : "";
+			out += '\t';
+			out += ai.data_title ? ai.data_title : "";
+			out += '\t';
+			out += ai.desc_content ? ai.desc_content : "";
+			out += '\n';
+		}
+	}
+}
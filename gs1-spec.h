@@ -1,58 +1,101 @@
-/*
-MIT License
-
-Copyright (c) 2021 Serge Reinov
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in all
-copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-SOFTWARE.
-*/
-
-#ifndef __GS1_SPEC_H__
-#define __GS1_SPEC_H__
-
-namespace GS1
-{
-
-	const char FNC1 = 0x1D;
-
-	//Rules for when FNC1Required is true:
-	//	parsing: expect FNC1 as an end-of-field sign, but don't require it
-	//  generation: if this is not the last field, then it is imperative to put FNC1 as an end sign (even reaching the maximum number of characters)
-
-	typedef struct _tag_AI
-	{
-		const char *ai;
-		const char *desc_content;
-		const char *desc_format;
-		bool FNC1_required;
-		const char *data_title;
-		int field_len;
-		int max_field_len_optional; //for constant length = 0, for variable length should be > field_len
-		int data_format;
-
-		operator const char*() const { return ai; }
-	} AI;
-
-	const int GS1_STRING = 0;
-	const int GS1_DATE = 1;
-	const int GS1_DECIMAL = 2;
-
-	const AI* get_ai(const char *gs1_field);
-}
-
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_SPEC_H__
+#define __GS1_SPEC_H__
+
+#include <string>
+
+namespace GS1
+{
+
+	const char FNC1 = 0x1D;
+
+	//Rules for when FNC1Required is true:
+	//	parsing: expect FNC1 as an end-of-field sign, but don't require it
+	//  generation: if this is not the last field, then it is imperative to put FNC1 as an end sign (even reaching the maximum number of characters)
+
+	typedef struct _tag_AI
+	{
+		const char *ai;
+		const char *desc_content;
+		const char *desc_format;
+		bool FNC1_required;
+		const char *data_title;
+		int field_len;
+		int max_field_len_optional; //for constant length = 0, for variable length should be > field_len
+		int data_format;
+
+		operator const char*() const { return ai; }
+	} AI;
+
+	//Packed part of an AI read by the parsers for every field, 8 bytes. The entries are kept
+	//in their own array (by id), apart from the description strings of AI.
+	typedef struct _tag_HotAI
+	{
+		unsigned char ai_len; //strlen(AI::ai)
+		unsigned char body_min; //field_len - ai_len
+		unsigned char body_max; //max_field_len_optional - ai_len, body_min for constant length
+		unsigned char flags; //HOT_*
+		unsigned char data_format;
+		unsigned char reserved;
+		unsigned short id; //get_ai_by_id() gives the full AI
+	} HotAI;
+
+	const int HOT_FNC1_REQUIRED = 1;
+	const int HOT_INVALID_LEN = 2; //field_len <= ai_len
+	const int HOT_INVALID_MAX_LEN = 4; //max_field_len_optional <= field_len
+
+	const int GS1_STRING = 0;
+	const int GS1_DATE = 1;
+	const int GS1_DECIMAL = 2;
+
+	const AI* get_ai(const char *gs1_field);
+	const AI* get_ai(const char *gs1_field, int len); //gs1_field may be not NUL-terminated
+	const AI* get_ai(const char *gs1_field, int len, const HotAI *&hot); //with the packed data, for parsers
+	const AI* get_ai_exact(const char *ai_code, int len); //whole code of a delimited AI, e.g. "3103" -> 310n; 0 if len differs
+	const AI* get_ai_exact(const char *ai_code, int len, const HotAI *&hot);
+
+	//dense spec ids: 0 .. get_ai_count()-1
+	int get_ai_count();
+	int get_ai_id(const AI *ai); //-1 if ai is not from the spec
+	const AI* get_ai_by_id(int id);
+	const HotAI* get_ai_hot(int id);
+	int find_ai_id(const char *ai); //exact AI::ai (e.g. "01", "310n"), -1 if not in the spec
+
+	//Runtime spec: replaces the compiled-in ai_list for all of the above (and so for parsing and validation).
+	//Dictionary text, one AI per line, tab separated (lines starting with # are comments):
+	//	ai	field_len	max_len	FNC1	format	desc_format	title	description
+	//	7003	14	0	1	string	N4+N10	EXPIRY TIME	Expiration date and time
+	//format is string, date or decimal; lengths include the AI as in ai_list.
+	//Load at startup, before other threads use the library: ids change, AI pointers of the previous spec stay valid.
+	//error_line: first bad line, or 0 if there are no entries or the file can't be read.
+	bool load_spec(const char *dictionary, int len, int &error_line);
+	bool load_spec_file(const char *path, int &error_line);
+	void reset_spec(); //back to ai_list
+	void format_spec(std::string &out); //current spec as dictionary text
+	unsigned int get_spec_version(); //changes on every load_spec()/reset_spec(), for tables indexed by AI id
+}
+
 #endif
\ No newline at end of file
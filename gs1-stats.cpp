@@ -0,0 +1,257 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-stats.h"
+
+#include <string.h>
+
+#ifdef GS1_STATS
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#endif
+
+namespace GS1
+{
+	void StatsGS1::Clear()
+	{
+		memset(this, 0, sizeof(*this));
+	}
+
+	void StatsGS1::Merge(const StatsGS1 &other)
+	{
+		scans += other.scans;
+		fields += other.fields;
+		for(int i=0; i<STATS_MAX_AI; i++)
+			by_ai[i] += other.by_ai[i];
+		for(int i=0; i<STATS_MAX_ERRORS; i++)
+			by_error[i] += other.by_error[i];
+
+		sampled_scans += other.sampled_scans;
+		for(int i=0; i<STATS_TIME_BUCKETS; i++)
+			time_hist[i] += other.time_hist[i];
+	}
+
+	unsigned long long StatsGS1::GetTimeQuantile(double q) const
+	{
+		if (sampled_scans == 0)
+			return 0;
+
+		unsigned long long rank = (unsigned long long)(q * (double)sampled_scans);
+		unsigned long long seen = 0;
+		for(int b=0; b<STATS_TIME_BUCKETS; b++)
+		{
+			seen += time_hist[b];
+			if (seen > rank)
+				return (2ULL << b) - 1;
+		}
+		return (2ULL << (STATS_TIME_BUCKETS - 1)) - 1;
+	}
+
+#ifdef GS1_STATS
+
+	//Counters are written by the owner thread only: relaxed load + store, no lock prefix.
+	//Atomics make the concurrent reads of stats_snapshot() well defined.
+	typedef std::atomic<unsigned long long> CounterGS1;
+
+	static inline void bump(CounterGS1 &c)
+	{
+		c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+
+	class StatsBlockGS1
+	{
+	public:
+		CounterGS1 scans;
+		CounterGS1 fields;
+		CounterGS1 by_ai[STATS_MAX_AI];
+		CounterGS1 by_error[STATS_MAX_ERRORS];
+		CounterGS1 sampled_scans;
+		CounterGS1 time_hist[STATS_TIME_BUCKETS];
+
+		unsigned int tick; //owner only
+		StatsBlockGS1 *next;
+
+		StatsBlockGS1() : tick(0), next(0)
+		{
+			clear();
+		}
+
+		void clear()
+		{
+			scans.store(0, std::memory_order_relaxed);
+			fields.store(0, std::memory_order_relaxed);
+			for(int i=0; i<STATS_MAX_AI; i++)
+				by_ai[i].store(0, std::memory_order_relaxed);
+			for(int i=0; i<STATS_MAX_ERRORS; i++)
+				by_error[i].store(0, std::memory_order_relaxed);
+			sampled_scans.store(0, std::memory_order_relaxed);
+			for(int i=0; i<STATS_TIME_BUCKETS; i++)
+				time_hist[i].store(0, std::memory_order_relaxed);
+		}
+
+		void add_to(StatsGS1 &result) const
+		{
+			result.scans += scans.load(std::memory_order_relaxed);
+			result.fields += fields.load(std::memory_order_relaxed);
+			for(int i=0; i<STATS_MAX_AI; i++)
+				result.by_ai[i] += by_ai[i].load(std::memory_order_relaxed);
+			for(int i=0; i<STATS_MAX_ERRORS; i++)
+				result.by_error[i] += by_error[i].load(std::memory_order_relaxed);
+			result.sampled_scans += sampled_scans.load(std::memory_order_relaxed);
+			for(int i=0; i<STATS_TIME_BUCKETS; i++)
+				result.time_hist[i] += time_hist[i].load(std::memory_order_relaxed);
+		}
+	};
+
+	static std::mutex registry_lock;
+	static StatsBlockGS1 *registry = 0; //all blocks, never freed
+	static std::atomic<unsigned int> sample_every(0); //0 - no timing, else a power of two
+
+	static thread_local StatsBlockGS1 *thread_block = 0;
+
+	static StatsBlockGS1* get_block()
+	{
+		StatsBlockGS1 *block = thread_block;
+		if (!block)
+		{
+			block = new StatsBlockGS1();
+			std::lock_guard<std::mutex> lock(registry_lock);
+			block->next = registry;
+			registry = block;
+			thread_block = block;
+		}
+		return block;
+	}
+
+	static inline long long now_ns()
+	{
+		return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void stats_field(const AI *ai)
+	{
+		StatsBlockGS1 *block = get_block();
+		bump(block->fields);
+		int id = get_ai_id(ai);
+		if ((id >= 0) && (id < STATS_MAX_AI))
+			bump(block->by_ai[id]);
+	}
+
+	void stats_error(int code)
+	{
+		if ((code >= 0) && (code < STATS_MAX_ERRORS))
+			bump(get_block()->by_error[code]);
+	}
+
+	StatsScanGS1::StatsScanGS1()
+		: block(get_block()), start(-1)
+	{
+		unsigned int every = sample_every.load(std::memory_order_relaxed);
+		if (every && ((block->tick++ & (every - 1)) == 0))
+			start = now_ns();
+	}
+
+	StatsScanGS1::~StatsScanGS1()
+	{
+		if (!block)
+			return;
+
+		bump(block->scans);
+		if (start >= 0)
+		{
+			unsigned long long ns = (unsigned long long)(now_ns() - start);
+			int b = 0;
+			while((ns >> (b + 1)) && (b < STATS_TIME_BUCKETS - 1))
+				b++;
+			bump(block->sampled_scans);
+			bump(block->time_hist[b]);
+		}
+	}
+
+	bool stats_enabled()
+	{
+		return true;
+	}
+
+	void stats_snapshot(StatsGS1 &result)
+	{
+		result.Clear();
+		std::lock_guard<std::mutex> lock(registry_lock);
+		for(StatsBlockGS1 *block=registry; block; block=block->next)
+			block->add_to(result);
+	}
+
+	void stats_snapshot_thread(StatsGS1 &result)
+	{
+		result.Clear();
+		get_block()->add_to(result);
+	}
+
+	void stats_reset()
+	{
+		std::lock_guard<std::mutex> lock(registry_lock);
+		for(StatsBlockGS1 *block=registry; block; block=block->next)
+			block->clear();
+	}
+
+	void stats_set_sample_rate(int n)
+	{
+		unsigned int every = 0;
+		if (n > 0)
+		{
+			every = 1;
+			while((every < (unsigned int)n) && (every < 0x40000000u))
+				every <<= 1;
+		}
+		sample_every.store(every, std::memory_order_relaxed);
+	}
+
+#else
+
+	bool stats_enabled()
+	{
+		return false;
+	}
+
+	void stats_snapshot(StatsGS1 &result)
+	{
+		result.Clear();
+	}
+
+	void stats_snapshot_thread(StatsGS1 &result)
+	{
+		result.Clear();
+	}
+
+	void stats_reset()
+	{
+	}
+
+	void stats_set_sample_rate(int)
+	{
+	}
+
+#endif
+}
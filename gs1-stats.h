@@ -0,0 +1,113 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_STATS_H__
+#define __GS1_STATS_H__
+
+#include "gs1-spec.h"
+
+//Parser metrics, compiled in only with GS1_STATS defined (project wide, needs C++11).
+//Without it the hooks below are empty and the snapshot functions return zeros.
+//
+//Every thread counts into its own block (no shared cache lines, no locked instructions),
+//stats_snapshot() sums the blocks of all threads that have parsed anything.
+//Blocks of exited threads are kept, so their counts are not lost.
+//Scans are counted by parse_gs1, FieldsGS1, ContextGS1, BatchGS1/BulkParserGS1 and LayoutGS1;
+//StreamParserGS1 counts fields and errors only.
+
+namespace GS1
+{
+	const int STATS_MAX_AI = 1024; //AI ids above are counted in fields only
+	const int STATS_MAX_ERRORS = 16; //ErrorAI::ErrorCode
+	const int STATS_TIME_BUCKETS = 32; //bucket b: [2^b, 2^(b+1)) ns
+
+	class StatsGS1
+	{
+	public:
+		unsigned long long scans;
+		unsigned long long fields;
+		unsigned long long by_ai[STATS_MAX_AI]; //by get_ai_id()
+		unsigned long long by_error[STATS_MAX_ERRORS]; //failed scans by ErrorAI::ErrorCode
+
+		unsigned long long sampled_scans;
+		unsigned long long time_hist[STATS_TIME_BUCKETS]; //parse time of sampled scans
+
+		StatsGS1() { Clear(); }
+
+		void Clear();
+		void Merge(const StatsGS1 &other);
+
+		//upper bound (ns) of the bucket holding the q-quantile (0..1) of sampled scans, 0 if none
+		unsigned long long GetTimeQuantile(double q) const;
+	};
+
+	bool stats_enabled(); //compiled with GS1_STATS
+
+	void stats_snapshot(StatsGS1 &result); //all threads
+	void stats_snapshot_thread(StatsGS1 &result); //calling thread
+	void stats_reset(); //all threads; counts of threads parsing meanwhile may survive
+
+	//time every n-th scan of each thread (rounded up to a power of two), 0 - no timing (default)
+	void stats_set_sample_rate(int n);
+
+#ifdef GS1_STATS
+
+	class StatsBlockGS1;
+
+	void stats_field(const AI *ai);
+	void stats_error(int code);
+
+	//counts a scan on destruction, times it when sampled
+	class StatsScanGS1
+	{
+	public:
+		StatsScanGS1();
+		~StatsScanGS1();
+
+		void cancel() { block = 0; } //scan is counted by another entry point
+
+	private:
+		StatsBlockGS1 *block;
+		long long start; //ns, <0 - not sampled
+
+		StatsScanGS1(const StatsScanGS1&);
+		StatsScanGS1& operator=(const StatsScanGS1&);
+	};
+
+#define GS1_STATS_FIELD(ai) GS1::stats_field(ai)
+#define GS1_STATS_ERROR(code) GS1::stats_error(code)
+#define GS1_STATS_SCAN(scope) GS1::StatsScanGS1 scope
+#define GS1_STATS_CANCEL(scope) scope.cancel()
+
+#else
+
+#define GS1_STATS_FIELD(ai) ((void)0)
+#define GS1_STATS_ERROR(code) ((void)0)
+#define GS1_STATS_SCAN(scope) ((void)0)
+#define GS1_STATS_CANCEL(scope) ((void)0)
+
+#endif
+}
+
+#endif
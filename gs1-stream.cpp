@@ -0,0 +1,194 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-stream.h"
+#include "gs1-stats.h"
+#include "gs1-simd.h"
+
+#include <string.h>
+
+namespace GS1
+{
+	StreamParserGS1::StreamParserGS1(StreamListenerGS1 *listener)
+		: listener(listener)
+	{
+		Reset();
+	}
+
+	void StreamParserGS1::Reset()
+	{
+		code_len = 0;
+		ai = 0;
+		ai_len = body_min = body_max = 0;
+		body.clear();
+		field_pos = 0;
+
+		pos = 0;
+		field_count = 0;
+		failed = false;
+		error.reset(0);
+	}
+
+	bool StreamParserGS1::fail(ErrorAI::ErrorCode code)
+	{
+		GS1_STATS_ERROR(code);
+		failed = true;
+		error.code = code;
+		error.ai = ai;
+		error.text_ai.assign(code, code_len);
+		error.reference_pos = field_pos;
+		return false;
+	}
+
+	//false: unknown AI or invalid spec, true: resolved or more digits needed
+	bool StreamParserGS1::resolve_ai()
+	{
+		if (!ai)
+		{
+			const HotAI *hot;
+			ai = get_ai(code, code_len, hot);
+			if (!ai)
+			{
+				unsigned char last = (unsigned char)(code[code_len - 1] - '0');
+				if ((code_len >= 4) || (last > 9))
+					return fail(ErrorAI::UnknownAI);
+				return true; //need more digits
+			}
+
+			ai_len = hot->ai_len;
+			if (hot->flags & HOT_INVALID_LEN)
+				return fail(ErrorAI::InvalidSpecLen);
+			if (hot->flags & HOT_INVALID_MAX_LEN)
+				return fail(ErrorAI::InvalidSpecMaxLen);
+
+			body_min = hot->body_min;
+			body_max = hot->body_max;
+		}
+		return true;
+	}
+
+	void StreamParserGS1::emit(const char *ptr, int len)
+	{
+		FieldView f;
+		f.ai = ai;
+		f.text_ai = TextView(code, ai_len);
+		if (body.empty())
+			f.text_body = TextView(ptr, len);
+		else
+		{
+			body.append(ptr, len);
+			f.text_body = TextView(body.data(), (int)body.length());
+		}
+		f.reference_pos = field_pos;
+		f.reference_len = ai_len + f.text_body.len;
+
+		field_count++;
+		GS1_STATS_FIELD(ai);
+		if (listener)
+			listener->OnField(f);
+
+		code_len = 0;
+		ai = 0;
+		body.clear();
+	}
+
+	bool StreamParserGS1::Push(const char *data, int len)
+	{
+		if (failed)
+			return false;
+
+		const char *ptr = data;
+		const char *end = data + len;
+		while(ptr < end)
+		{
+			if (!ai || (code_len < ai_len))
+			{
+				if ((code_len == 0) && (field_count > 0))
+				{
+					while((ptr < end) && (*ptr == GS1::FNC1))
+						ptr++; //skip FNC1 after the previous field
+					if (ptr == end)
+						break;
+				}
+				if (code_len == 0)
+					field_pos = pos + (int)(ptr - data);
+
+				if (code_len >= (int)sizeof(code))
+					return fail(ErrorAI::UnknownAI);
+				code[code_len++] = *ptr++;
+				if (!resolve_ai())
+					return false;
+				continue;
+			}
+
+			//body: up to the max length, FNC1 or the end of chunk
+			int have = (int)body.length();
+			const char *limit = ptr + (body_max - have);
+			if (limit > end)
+				limit = end;
+
+			const char *stop = find_gs1_fnc1(ptr, limit);
+			int n = (int)(stop - ptr);
+			if (stop < limit)
+			{
+				//FNC1 closes the field, it is skipped at the next field start
+				if (have + n < body_min)
+					return fail((have + n == 0) ? ErrorAI::EmptyBody : ErrorAI::BodyTooShort);
+				emit(ptr, n);
+			}
+			else if (have + n == body_max)
+				emit(ptr, n);
+			else
+				body.append(ptr, n); //field continues in the next chunk
+
+			ptr = stop;
+		}
+
+		pos += len;
+		return true;
+	}
+
+	bool StreamParserGS1::End()
+	{
+		bool ok = !failed;
+		if (ok && (code_len > 0))
+		{
+			//unresolved AI at the end: incomplete wildcard AI or unknown
+			if (!ai)
+				ai = get_ai(code, code_len);
+
+			if (!ai)
+				ok = fail(ErrorAI::UnknownAI);
+			else if ((code_len < ai_len) || ((int)body.length() < body_min))
+				ok = fail(ErrorAI::EmptyBody);
+			else
+				emit(body.data(), 0); //variable length field closed by the end of scan
+		}
+
+		ErrorAI last_error = error;
+		Reset();
+		error = last_error;
+		return ok;
+	}
+}
@@ -0,0 +1,90 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_STREAM_H__
+#define __GS1_STREAM_H__
+
+#include "gs1-parse.h"
+
+#include <string>
+
+namespace GS1
+{
+	class StreamListenerGS1
+	{
+	public:
+		virtual ~StreamListenerGS1() {}
+
+		//field spans are valid only during the call, use FieldView::to_field() to keep it
+		virtual void OnField(const FieldView &field) = 0;
+	};
+
+	//Incremental parser for chunked scanner input.
+	//A field is reported as soon as its fixed length is reached or FNC1 closes it;
+	//only the not yet closed field is kept between chunks (AI digits + body received so far).
+	//Differences from parse_gs1: reference_len does not include FNC1 separators,
+	//a body cut by FNC1 is EmptyBody right after the AI and BodyTooShort otherwise, also where parse_gs1
+	//gives EmptyBody because the whole scan ends before the minimum length (the rest is unknown yet).
+	class StreamParserGS1
+	{
+	public:
+		explicit StreamParserGS1(StreamListenerGS1 *listener);
+
+		//feed next chunk of the current scan; false once the scan has failed (see GetError)
+		bool Push(const char *data, int len);
+
+		//end of scan: closes the last variable length field, false if the scan failed;
+		//the parser is reset and ready for the next scan
+		bool End();
+
+		void Reset();
+
+		const ErrorAI& GetError() const { return error; }
+		int GetFieldCount() const { return field_count; } //fields reported in the current scan
+
+	protected:
+		bool resolve_ai();
+		void emit(const char *ptr, int len);
+		bool fail(ErrorAI::ErrorCode code);
+
+		StreamListenerGS1 *listener;
+
+		//current field
+		char code[4];
+		int code_len;
+		const AI *ai;
+		int ai_len;
+		int body_min;
+		int body_max;
+		std::string body; //body bytes of previous chunks, empty while the field is inside one chunk
+		int field_pos;
+
+		int pos; //bytes of the scan consumed
+		int field_count;
+		bool failed;
+		ErrorAI error;
+	};
+}
+
+#endif
@@ -0,0 +1,255 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gs1-validate.h"
+#include "gs1-simd.h"
+
+#include <stdlib.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace GS1
+{
+	//AIs whose first body segment ends with a mod-10 check digit
+	static const char *check_digit_ai[] =
+	{
+		"00", "01", "02", "253", "255", "402",
+		"410", "411", "412", "413", "414", "415", "416", "417",
+		"8003", "8006", "8017", "8018"
+	};
+
+	const int MAX_SEGMENTS = 4;
+
+	//desc_format of one AI without the AI part, e.g. "N3+N13+X..17" -> N13, X..17
+	class RuleAI
+	{
+	public:
+		int count;
+		char type[MAX_SEGMENTS]; //'N' or 'X'
+		int len[MAX_SEGMENTS]; //fixed length, 0 - the rest of the body
+		bool check_digit; //last char of the first segment
+
+		void build(const AI *ai)
+		{
+			count = 0;
+			check_digit = false;
+
+			const char *p = ai->desc_format ? strchr(ai->desc_format, '+') : 0;
+			while(p && (count < MAX_SEGMENTS))
+			{
+				p++; //'+'
+				type[count] = *p++;
+				char *next;
+				len[count] = (int)strtol(p, &next, 10);
+				if ((next[0] == '.') && (next[1] == '.'))
+					len[count] = 0; //X..20, N6..12
+				count++;
+				p = strchr(p, '+');
+			}
+
+			for(size_t i=0; i<sizeof(check_digit_ai)/sizeof(check_digit_ai[0]); i++)
+			{
+				if (strcmp(ai->ai, check_digit_ai[i]) == 0)
+					check_digit = (count > 0) && (type[0] == 'N') && (len[0] > 1);
+			}
+		}
+	};
+
+	class RulesAI
+	{
+	public:
+		RulesAI()
+		{
+			version = get_spec_version();
+			count = get_ai_count();
+			rules = new RuleAI[count];
+			for(int i=0; i<count; i++)
+				rules[i].build(get_ai_by_id(i));
+		}
+		~RulesAI() { delete [] rules; }
+
+		const RuleAI* get(int id) const { return ((id >= 0) && (id < count)) ? &rules[id] : 0; }
+
+		unsigned int version; //get_spec_version() the rules were built for
+
+	private:
+		RuleAI *rules;
+		int count;
+	};
+
+	//rules of the current spec, published with one CAS: validation runs on many threads
+	static RulesAI *current_rules = 0;
+
+#ifdef _MSC_VER
+	static inline RulesAI* load_rules() { return (RulesAI*)_InterlockedCompareExchangePointer((void* volatile*)&current_rules, 0, 0); }
+	static inline bool publish_rules(RulesAI *expected, RulesAI *rules) { return _InterlockedCompareExchangePointer((void* volatile*)&current_rules, rules, expected) == expected; }
+#else
+	static inline RulesAI* load_rules() { return __atomic_load_n(&current_rules, __ATOMIC_ACQUIRE); }
+	static inline bool publish_rules(RulesAI *expected, RulesAI *rules) { return __atomic_compare_exchange_n(&current_rules, &expected, rules, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); }
+#endif
+
+	static const RulesAI& default_rules()
+	{
+		unsigned int version = get_spec_version();
+		for(;;)
+		{
+			RulesAI *rules = load_rules();
+			if (rules && (rules->version == version))
+				return *rules;
+
+			//first call or after load_spec(): like specs, old rules are kept for callers still holding them
+			RulesAI *built = new RulesAI();
+			if (publish_rules(rules, built))
+				return *built;
+			delete built; //another thread won, use its rules
+		}
+	}
+
+	static ErrorAI::ErrorCode validate_body(const RuleAI *rule, const char *body, int body_len)
+	{
+		if (!rule)
+			return ErrorAI::Ok; //not from the spec, nothing to check
+
+		int pos = 0;
+		for(int i=0; (i<rule->count) && (pos<body_len); i++)
+		{
+			int len = body_len - pos;
+			if ((rule->len[i] > 0) && (rule->len[i] < len))
+				len = rule->len[i];
+
+			const char *seg = body + pos;
+			if ((i == 0) && rule->check_digit && (len == rule->len[0]))
+			{
+				int check = check_mod10(seg, len); //digits and check digit in one pass
+				if (check < 0)
+					return ErrorAI::InvalidChar;
+				if (check == 0)
+					return ErrorAI::InvalidCheckDigit;
+			}
+			else if (rule->type[i] == 'N')
+			{
+				if (!isstrdigit(seg, len))
+					return ErrorAI::InvalidChar;
+			}
+			else if (!isstrcset82(seg, len))
+				return ErrorAI::InvalidChar;
+
+			pos += len;
+		}
+		return ErrorAI::Ok;
+	}
+
+	int mod10_check_digit(const char *ptr, int len)
+	{
+		int sum = 0;
+		int weight = (len & 1) ? 3 : 1; //3 for the rightmost digit
+		for(int i=0; i<len; i++)
+		{
+			sum += (ptr[i] - '0') * weight;
+			weight = 4 - weight;
+		}
+		return (10 - sum % 10) % 10;
+	}
+
+	static bool field_error(ErrorView &error, ErrorAI::ErrorCode code, const FieldView &field)
+	{
+		error.code = code;
+		error.ai = field.ai;
+		error.text_ai = field.text_ai;
+		error.reference_pos = field.reference_pos;
+		return false;
+	}
+
+	bool validate_field(const FieldView &field, ErrorView &error)
+	{
+		error.reset(field.reference_pos);
+
+		ErrorAI::ErrorCode code = validate_body(default_rules().get(get_ai_id(field.ai)), field.text_body.ptr, field.text_body.len);
+		if (code != ErrorAI::Ok)
+			return field_error(error, code, field);
+		return true;
+	}
+
+	bool validate_gs1(const FieldView *fields, int count, ErrorView &error)
+	{
+		error.reset(0);
+
+		const RulesAI &rules = default_rules();
+		for(int i=0; i<count; i++)
+		{
+			const FieldView &f = fields[i];
+			ErrorAI::ErrorCode code = validate_body(rules.get(get_ai_id(f.ai)), f.text_body.ptr, f.text_body.len);
+			if (code != ErrorAI::Ok)
+				return field_error(error, code, f);
+		}
+		return true;
+	}
+
+	bool validate_gs1(const std::vector<FieldAI> &fields, ErrorAI &error)
+	{
+		error.reset(0);
+
+		const RulesAI &rules = default_rules();
+		for(size_t i=0; i<fields.size(); i++)
+		{
+			const FieldAI &f = fields[i];
+			ErrorAI::ErrorCode code = validate_body(rules.get(get_ai_id(f.ai)), f.text_body.c_str(), (int)f.text_body.size());
+			if (code != ErrorAI::Ok)
+			{
+				error.code = code;
+				error.ai = f.ai;
+				error.text_ai = f.text_ai;
+				error.reference_pos = f.reference_pos;
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool validate_gs1(const BatchGS1 &batch, const char * const *scans, unsigned char *error_codes)
+	{
+		const RulesAI &rules = default_rules();
+		const int *scan_index = batch.GetScanIndex();
+		const int *body_pos = batch.GetBodyPos();
+		const short *body_len = batch.GetBodyLen();
+		const short *ai_id = batch.GetAIId();
+		const unsigned char *parse_code = batch.GetErrorCode();
+
+		bool ok = true;
+		int count = batch.GetCount();
+		for(int i=0; i<count; i++)
+		{
+			unsigned char code = parse_code[i];
+			if (code == ErrorAI::Ok)
+				code = (unsigned char)validate_body(rules.get(ai_id[i]), scans[scan_index[i]] + body_pos[i], body_len[i]);
+
+			error_codes[i] = code;
+			if (code != ErrorAI::Ok)
+				ok = false;
+		}
+		return ok;
+	}
+}
@@ -0,0 +1,54 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __GS1_VALIDATE_H__
+#define __GS1_VALIDATE_H__
+
+#include "gs1-parse.h"
+#include "gs1-batch.h"
+
+namespace GS1
+{
+	//Optional validation of parsed fields against desc_format:
+	//N segments must be digits, X segments GS1 character set 82, and the mod-10 check digit
+	//of 00, 01, 02, 253, 255, 402, 410..417, 8003, 8006, 8017, 8018 must match.
+	//Errors are InvalidChar or InvalidCheckDigit with reference_pos of the field.
+
+	bool validate_field(const FieldView &field, ErrorView &error);
+
+	//GS1 mod-10 check digit (0..9) of len digits, weights 3,1,3,... from the right
+	int mod10_check_digit(const char *ptr, int len);
+
+	//first invalid field stops validation
+	bool validate_gs1(const FieldView *fields, int count, ErrorView &error);
+	inline bool validate_gs1(const std::vector<FieldView> &fields, ErrorView &error) { return validate_gs1(fields.empty() ? 0 : &fields[0], (int)fields.size(), error); }
+	bool validate_gs1(const std::vector<FieldAI> &fields, ErrorAI &error);
+
+	//batch mode: error_codes (batch.GetCount() items) gets the ErrorAI code of every row,
+	//error rows keep their parse error; false if any row is not Ok.
+	//Rows are checked one by one with the same kernels as validate_field (no work shared across rows)
+	bool validate_gs1(const BatchGS1 &batch, const char * const *scans, unsigned char *error_codes);
+}
+
+#endif
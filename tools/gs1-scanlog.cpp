@@ -0,0 +1,590 @@
+/*
+MIT License
+
+Copyright (c) 2021 Serge Reinov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//Bulk processing of scan logs (one scan per line).
+//	gs1-scanlog [-t threads] [-m aggregate|hri|json] [-e escape]... [-d dictionary] [-o output] log
+//The log is memory-mapped and split into blocks that worker threads parse in parallel;
+//-m hri/json writes one record per input line in input order, aggregate prints per-AI counts.
+//FNC1 may be raw 0x1D or escaped: <GS>, \x1D, \x1d, {GS} unless -e options are given.
+//Lines starting with http:// or https:// are parsed as GS1 Digital Link URIs, lines starting with '(' as bracketed HRI.
+//A leading symbology identifier (e.g. ]C1, ]d2) and a trailing CR are ignored.
+
+#include "../gs1-parse.h"
+#include "../gs1-format.h"
+#include "../gs1-hri.h"
+#include "../gs1-link.h"
+#include "../gs1-simd.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	const size_t BLOCK_SIZE = 8 << 20; //bytes of log per work item
+	const int MAX_ERRORS = 16;
+
+	const char *const error_names[] = { "Ok", "UnknownAI", "InvalidSpecLen", "InvalidSpecMaxLen", "EmptyBody",
+		"BodyTooShort", "BodyTooLong", "BufferTooSmall", "InvalidChar", "InvalidCheckDigit", "MissingAI", "ExcludedAI" };
+
+	enum Mode
+	{
+		Aggregate,
+		ExtractHRI,
+		ExtractJSON
+	};
+
+	//read-only mapping of the whole log
+	class MappedLog
+	{
+	public:
+		const char *data;
+		size_t size;
+
+		MappedLog() : data(0), size(0)
+		{
+#ifdef _WIN32
+			handle = INVALID_HANDLE_VALUE;
+			mapping = 0;
+#else
+			fd = -1;
+#endif
+		}
+
+		~MappedLog()
+		{
+#ifdef _WIN32
+			if (data)
+				UnmapViewOfFile(data);
+			if (mapping)
+				CloseHandle(mapping);
+			if (handle != INVALID_HANDLE_VALUE)
+				CloseHandle(handle);
+#else
+			if (data)
+				munmap((void*)data, size);
+			if (fd >= 0)
+				close(fd);
+#endif
+		}
+
+		bool open(const char *path)
+		{
+#ifdef _WIN32
+			handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+			if (handle == INVALID_HANDLE_VALUE)
+				return false;
+			LARGE_INTEGER file_size;
+			if (!GetFileSizeEx(handle, &file_size))
+				return false;
+			size = (size_t)file_size.QuadPart;
+			if (size == 0)
+				return true;
+			mapping = CreateFileMappingA(handle, 0, PAGE_READONLY, 0, 0, 0);
+			if (!mapping)
+				return false;
+			data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			return data != 0;
+#else
+			fd = ::open(path, O_RDONLY);
+			if (fd < 0)
+				return false;
+			struct stat st;
+			if (fstat(fd, &st) != 0)
+				return false;
+			size = (size_t)st.st_size;
+			if (size == 0)
+				return true;
+			void *view = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (view == MAP_FAILED)
+				return false;
+			madvise(view, size, MADV_SEQUENTIAL);
+			data = (const char*)view;
+			return true;
+#endif
+		}
+
+	private:
+#ifdef _WIN32
+		HANDLE handle;
+		HANDLE mapping;
+#else
+		int fd;
+#endif
+	};
+
+	//per-thread counters, merged at the end
+	class Totals
+	{
+	public:
+		unsigned long long lines;
+		unsigned long long scans_ok;
+		unsigned long long scans_failed;
+		unsigned long long fields;
+		std::vector<unsigned long long> by_ai;
+		unsigned long long by_error[MAX_ERRORS];
+
+		Totals() : lines(0), scans_ok(0), scans_failed(0), fields(0), by_ai(GS1::get_ai_count(), 0)
+		{
+			memset(by_error, 0, sizeof(by_error));
+		}
+
+		void merge(const Totals &other)
+		{
+			lines += other.lines;
+			scans_ok += other.scans_ok;
+			scans_failed += other.scans_failed;
+			fields += other.fields;
+			for(size_t i=0; i<by_ai.size(); i++)
+				by_ai[i] += other.by_ai[i];
+			for(int i=0; i<MAX_ERRORS; i++)
+				by_error[i] += other.by_error[i];
+		}
+	};
+
+	class Options
+	{
+	public:
+		Mode mode;
+		int threads;
+		std::vector<std::string> escapes;
+		const char *input;
+		const char *output;
+		const char *dictionary; //load_spec_file()
+
+		Options() : mode(Aggregate), threads(0), input(0), output(0), dictionary(0) {}
+	};
+
+	//escaped FNC1 -> 0x1D, only called for lines containing the first char of an escape
+	class Unescaper
+	{
+	public:
+		explicit Unescaper(const std::vector<std::string> &escapes) : escapes(escapes)
+		{
+			memset(first, 0, sizeof(first));
+			for(size_t i=0; i<escapes.size(); i++)
+				first[(unsigned char)escapes[i][0]] = 1;
+		}
+
+		//true if text was rewritten into buffer
+		bool run(const char *text, int len, std::string &buffer) const
+		{
+			int i = 0;
+			while((i < len) && !first[(unsigned char)text[i]])
+				i++;
+			if (i == len)
+				return false;
+
+			buffer.assign(text, i);
+			while(i < len)
+			{
+				size_t e = 0;
+				if (first[(unsigned char)text[i]])
+				{
+					for(; e<escapes.size(); e++)
+					{
+						const std::string &esc = escapes[e];
+						if ((len - i >= (int)esc.length()) && !memcmp(text + i, esc.data(), esc.length()))
+							break;
+					}
+				}
+				if (first[(unsigned char)text[i]] && (e < escapes.size()))
+				{
+					buffer.push_back(GS1::FNC1);
+					i += (int)escapes[e].length();
+				}
+				else
+					buffer.push_back(text[i++]);
+			}
+			return true;
+		}
+
+	private:
+		const std::vector<std::string> &escapes;
+		unsigned char first[256];
+	};
+
+	//work item: lines of [begin, end), output kept until it is written in order
+	class Block
+	{
+	public:
+		const char *begin;
+		const char *end;
+		std::string out;
+		bool done;
+
+		Block() : begin(0), end(0), done(false) {}
+	};
+
+	class Job
+	{
+	public:
+		Job(const Options &options, const MappedLog &log, FILE *out)
+			: options(options), out(out), unescaper(options.escapes), next(0), written(0)
+		{
+			//block boundaries after a newline
+			const char *ptr = log.data;
+			const char *end = log.data + log.size;
+			while(ptr < end)
+			{
+				const char *stop = (end - ptr > (ptrdiff_t)BLOCK_SIZE) ? ptr + BLOCK_SIZE : end;
+				if (stop < end)
+				{
+					stop = GS1::find_byte(stop, end, '\n');
+					if (stop < end)
+						stop++;
+				}
+				Block block;
+				block.begin = ptr;
+				block.end = stop;
+				blocks.push_back(block);
+				ptr = stop;
+			}
+		}
+
+		void run(int threads)
+		{
+			totals.resize(threads);
+			std::vector<std::thread> workers;
+			for(int t=1; t<threads; t++)
+				workers.push_back(std::thread(&Job::work, this, t));
+			work(0);
+			for(size_t t=0; t<workers.size(); t++)
+				workers[t].join();
+			flush();
+		}
+
+		Totals total() const
+		{
+			Totals result;
+			for(size_t t=0; t<totals.size(); t++)
+				result.merge(totals[t]);
+			return result;
+		}
+
+	private:
+		//blocks are taken in order; a worker may run at most `window` blocks ahead of the writer
+		void work(int thread)
+		{
+			const size_t window = totals.size() * 4;
+			Totals &local = totals[thread];
+			std::vector<GS1::FieldView> fields;
+			std::string unescaped;
+
+			for(;;)
+			{
+				size_t b = next.fetch_add(1);
+				if (b >= blocks.size())
+					break;
+
+				if (options.mode != Aggregate)
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					cv.wait(lock, [&] { return b < written + window; });
+				}
+
+				Block &block = blocks[b];
+				parse_block(block, local, fields, unescaped);
+
+				if (options.mode != Aggregate)
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					block.done = true;
+					write_ready();
+					cv.notify_all();
+				}
+			}
+		}
+
+		void parse_block(Block &block, Totals &local, std::vector<GS1::FieldView> &fields, std::string &unescaped)
+		{
+			const char *ptr = block.begin;
+			while(ptr < block.end)
+			{
+				const char *eol = GS1::find_byte(ptr, block.end, '\n');
+				const char *line = ptr;
+				int len = (int)(eol - ptr);
+				ptr = (eol < block.end) ? eol + 1 : eol;
+
+				if ((len > 0) && (line[len - 1] == '\r'))
+					len--;
+				if ((len >= 3) && (line[0] == ']'))
+				{
+					line += 3; //symbology identifier
+					len -= 3;
+				}
+				if (len == 0)
+				{
+					if (options.mode != Aggregate)
+						block.out.push_back('\n');
+					continue;
+				}
+
+				local.lines++;
+				GS1::ErrorView error;
+				bool ok;
+				if (GS1::is_digital_link(line, len))
+				{
+					unescaped.assign(line, len); //decoded in place
+					ok = GS1::parse_digital_link(fields, &unescaped[0], len, error);
+				}
+				else if (line[0] == '(')
+					ok = GS1::parse_hri(fields, line, len, error);
+				else
+				{
+					if (unescaper.run(line, len, unescaped))
+					{
+						line = unescaped.data();
+						len = (int)unescaped.length();
+					}
+					ok = GS1::parse_gs1(fields, line, len, error);
+				}
+				if (ok)
+					local.scans_ok++;
+				else
+				{
+					local.scans_failed++;
+					if ((error.code >= 0) && (error.code < MAX_ERRORS))
+						local.by_error[error.code]++;
+				}
+				local.fields += fields.size();
+				for(size_t f=0; f<fields.size(); f++)
+				{
+					int id = GS1::get_ai_id(fields[f].ai);
+					if ((id >= 0) && (id < (int)local.by_ai.size()))
+						local.by_ai[id]++;
+				}
+
+				switch(options.mode)
+				{
+				case ExtractHRI:
+					if (ok)
+						GS1::format_hri(block.out, fields);
+					else
+						error_record(block.out, error, false);
+					block.out.push_back('\n');
+					break;
+				case ExtractJSON:
+					if (ok)
+						GS1::format_json(block.out, fields);
+					else
+						error_record(block.out, error, true);
+					block.out.push_back('\n');
+					break;
+				default:
+					break;
+				}
+			}
+		}
+
+		static void error_record(std::string &out, const GS1::ErrorView &error, bool json)
+		{
+			char buf[80];
+			if (json)
+				snprintf(buf, sizeof(buf), "{\"error\":%d,\"pos\":%d}", (int)error.code, error.reference_pos);
+			else
+				snprintf(buf, sizeof(buf), "#error %d at %d", (int)error.code, error.reference_pos);
+			out.append(buf);
+		}
+
+		//called under mutex: writes finished blocks in order
+		void write_ready()
+		{
+			while((written < blocks.size()) && blocks[written].done)
+			{
+				Block &block = blocks[written];
+				if (!block.out.empty())
+					fwrite(block.out.data(), 1, block.out.size(), out);
+				std::string().swap(block.out);
+				written++;
+			}
+		}
+
+		void flush()
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			write_ready();
+		}
+
+		const Options &options;
+		FILE *out;
+		Unescaper unescaper;
+
+		std::vector<Block> blocks;
+		std::vector<Totals> totals;
+		std::atomic<size_t> next;
+
+		std::mutex mutex;
+		std::condition_variable cv;
+		size_t written;
+	};
+
+	void usage()
+	{
+		fprintf(stderr, "usage: gs1-scanlog [-t threads] [-m aggregate|hri|json] [-e escape]... [-d dictionary] [-o output] log\n");
+	}
+
+	bool parse_options(int argc, char *argv[], Options &options)
+	{
+		for(int i=1; i<argc; i++)
+		{
+			const char *arg = argv[i];
+			const char *value = (i + 1 < argc) ? argv[i + 1] : 0;
+			if (!strcmp(arg, "-t") && value)
+			{
+				options.threads = atoi(value);
+				i++;
+			}
+			else if (!strcmp(arg, "-m") && value)
+			{
+				if (!strcmp(value, "aggregate"))
+					options.mode = Aggregate;
+				else if (!strcmp(value, "hri"))
+					options.mode = ExtractHRI;
+				else if (!strcmp(value, "json"))
+					options.mode = ExtractJSON;
+				else
+					return false;
+				i++;
+			}
+			else if (!strcmp(arg, "-e") && value)
+			{
+				if (!*value)
+					return false;
+				options.escapes.push_back(value);
+				i++;
+			}
+			else if (!strcmp(arg, "-d") && value)
+			{
+				options.dictionary = value;
+				i++;
+			}
+			else if (!strcmp(arg, "-o") && value)
+			{
+				options.output = value;
+				i++;
+			}
+			else if ((arg[0] != '-') && !options.input)
+				options.input = arg;
+			else
+				return false;
+		}
+
+		if (options.escapes.empty())
+		{
+			options.escapes.push_back("<GS>");
+			options.escapes.push_back("\\x1D");
+			options.escapes.push_back("\\x1d");
+			options.escapes.push_back("{GS}");
+		}
+		if (options.threads <= 0)
+			options.threads = (int)std::thread::hardware_concurrency();
+		if (options.threads <= 0)
+			options.threads = 1;
+		return options.input != 0;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	Options options;
+	if (!parse_options(argc, argv, options))
+	{
+		usage();
+		return 2;
+	}
+
+	int error_line;
+	if (options.dictionary && !GS1::load_spec_file(options.dictionary, error_line))
+	{
+		fprintf(stderr, "gs1-scanlog: cannot load %s (line %d)\n", options.dictionary, error_line);
+		return 1;
+	}
+
+	MappedLog log;
+	if (!log.open(options.input))
+	{
+		fprintf(stderr, "gs1-scanlog: cannot map %s\n", options.input);
+		return 1;
+	}
+
+	FILE *out = stdout;
+	if (options.output && !(out = fopen(options.output, "wb")))
+	{
+		fprintf(stderr, "gs1-scanlog: cannot create %s\n", options.output);
+		return 1;
+	}
+
+	std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+	Job job(options, log, out);
+	job.run(options.threads);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+	Totals totals = job.total();
+	FILE *report = (options.mode == Aggregate) ? out : stderr;
+	fprintf(report, "lines %llu, scans ok %llu, failed %llu, fields %llu, %.1f MB/s (%d threads)\n",
+		totals.lines, totals.scans_ok, totals.scans_failed, totals.fields,
+		(seconds > 0) ? (double)log.size / seconds / 1e6 : 0.0, options.threads);
+
+	if (options.mode == Aggregate)
+	{
+		for(size_t id=0; id<totals.by_ai.size(); id++)
+		{
+			if (totals.by_ai[id])
+			{
+				const GS1::AI *ai = GS1::get_ai_by_id((int)id);
+				fprintf(out, "%-6s %12llu  %s\n", ai->ai, totals.by_ai[id], ai->data_title ? ai->data_title : "");
+			}
+		}
+		for(int code=1; code<MAX_ERRORS; code++)
+		{
+			if (totals.by_error[code])
+			{
+				const char *name = (code < (int)(sizeof(error_names) / sizeof(error_names[0]))) ? error_names[code] : "?";
+				fprintf(out, "error %-18s %12llu\n", name, totals.by_error[code]);
+			}
+		}
+	}
+
+	if (out != stdout)
+		fclose(out);
+	return 0;
+}